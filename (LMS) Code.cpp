@@ -2,6 +2,7 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <set>
 #include <map>
 #include <chrono>
@@ -13,20 +14,76 @@
 #include <algorithm>
 #include <stdexcept>
 #include <limits>
+#include <random>
+#include <queue>
+#include <deque>
+#include <cmath>
+#include <cstdint>
+#include <bitset>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <climits>
+#include <cstring>
+#include <cerrno>
+#include <type_traits>
+#include <functional>
+#include <string_view>
+#include <cstdio>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 // Constants
 const int MAX_BORROW_LIMIT = 5;
 const int MAX_REVIEW_LENGTH = 500;
-const int MAX_BOOKS_IN_LIBRARY = 10000;
+const int MAX_BOOKS_IN_LIBRARY = 1000000;
 const int MAX_USERS = 1000;
 const int MAX_ADMINS = 50;
 const int MAX_LOGIN_ATTEMPTS = 3;
 const int SESSION_TIMEOUT_MINUTES = 30;
 const double LATE_FEE_PER_DAY = 0.50;
 const int MAX_BORROW_DAYS = 14;
+const int MAX_RENEWALS = 2;
 const int PREMIUM_BORROW_DAYS = 21;
+const int OVERDUE_NOTICE_INTERVAL_DAYS = 7;
+const size_t TRANSACTION_SEGMENT_SIZE = 4096;
+const int NOTIFICATION_MAX_AGE_DAYS = 180;
+const int NOTIFICATION_READ_MAX_AGE_DAYS = 30;
+const size_t MAX_NOTIFICATIONS_PER_USER = 100;
+const size_t NOTIFICATION_COMPACT_MIN_DEAD = 1024;
+const size_t NOTIFICATION_QUEUE_CAPACITY = 4096;
+const size_t NOTIFICATION_BATCH_SIZE = 64;
+const uint32_t SNAPSHOT_VERSION = 3;
+const size_t SNAPSHOT_BUFFER_SIZE = 1 << 20;
+const char* const SNAPSHOT_FILE = "library.snap";
+const char SNAPSHOT_MAGIC[8] = {'L', 'M', 'S', 'S', 'N', 'A', 'P', '\0'};
+const char* const WAL_FILE = "library.wal";
+const size_t WAL_GROUP_COMMIT_MAX_RECORDS = 256;
+const int WAL_GROUP_COMMIT_DELAY_MICROS = 0;
+const uint32_t CATALOG_IMAGE_VERSION = 1;
+const char* const CATALOG_IMAGE_FILE = "catalog.img";
+const char CATALOG_IMAGE_MAGIC[8] = {'L', 'M', 'S', 'C', 'I', 'M', 'G', '\0'};
+const size_t KIOSK_SEARCH_LIMIT = 20;
+const size_t IMPORT_CHUNK_BYTES = 4 << 20;
+const size_t IMPORT_MAX_REPORTED_ERRORS = 20;
+const size_t EXPORT_BUFFER_SIZE = 1 << 20;
+const int MAX_FUZZY_RESULTS = 20;
+const int AUTOCOMPLETE_TOP_N = 10;
+const size_t MAX_PREFIX_TERMS = 256;     // past this many completions, candidates are checked one by one
+const size_t MIN_PREFIX_LENGTH = 3;      // shorter last words must match a whole word
+const double BM25_K1 = 1.2;
+const double BM25_B = 0.75;
 
 // Forward declarations
 class Book;
@@ -36,24 +93,32 @@ class Library;
 class Transaction;
 class NotificationSystem;
 
-// Utility functions
-namespace LibraryUtils {
-    string getCurrentDateTime() {
-        time_t now = time(0);
-        tm* ltm = localtime(&now);
-        char buffer[80];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", ltm);
-        return string(buffer);
-    }
+// Time source for the whole system; tests can install a FakeClock
+class Clock {
+public:
+    virtual ~Clock() {}
+    virtual time_t now() const = 0;
+};
 
-    string getCurrentDate() {
-        time_t now = time(0);
-        tm* ltm = localtime(&now);
-        char buffer[11];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d", ltm);
-        return string(buffer);
-    }
+class SystemClock : public Clock {
+public:
+    time_t now() const override { return time(0); }
+};
+
+class FakeClock : public Clock {
+private:
+    atomic<time_t> current;
+
+public:
+    explicit FakeClock(time_t start) : current(start) {}
+
+    time_t now() const override { return current.load(); }
+    void set(time_t time) { current = time; }
+    void advance(time_t seconds) { current += seconds; }
+};
 
+// Utility functions
+namespace LibraryUtils {
     bool validatePassword(const string& password) {
         if (password.length() < 8) return false;
         bool hasUpper = false, hasLower = false, hasDigit = false, hasSpecial = false;
@@ -73,25 +138,230 @@ namespace LibraryUtils {
         return dot != string::npos && dot > at + 1 && dot < email.length() - 1;
     }
 
+    int isbn13CheckDigit(const string& first12) {
+        int sum = 0;
+        for (int i = 0; i < 12; ++i) {
+            sum += (first12[i] - '0') * (i % 2 ? 3 : 1);
+        }
+        return (10 - sum % 10) % 10;
+    }
+
     string generateISBN() {
         static random_device rd;
         static mt19937 gen(rd());
         uniform_int_distribution<> dis(0, 9);
-        string isbn;
-        for (int i = 0; i < 13; ++i) {
+        string isbn = "978";
+        for (int i = 0; i < 9; ++i) {
             isbn += to_string(dis(gen));
         }
-        return isbn;
+        return isbn + to_string(isbn13CheckDigit(isbn));
+    }
+
+    // Validates an ISBN-10 or ISBN-13 (hyphens and spaces allowed) and maps
+    // both forms to the same key: the 13-digit ISBN as an integer.
+    bool normalizeISBN(const string& isbn, uint64_t& key) {
+        string digits;
+        for (char c : isbn) {
+            if (c == '-' || c == ' ') continue;
+            digits += toupper(static_cast<unsigned char>(c));
+        }
+
+        if (digits.length() == 10) {
+            int sum = 0;
+            for (int i = 0; i < 10; ++i) {
+                int value;
+                if (isdigit(static_cast<unsigned char>(digits[i]))) value = digits[i] - '0';
+                else if (digits[i] == 'X' && i == 9) value = 10;
+                else return false;
+                sum += value * (10 - i);
+            }
+            if (sum % 11 != 0) return false;
+            digits = "978" + digits.substr(0, 9);
+            digits += to_string(isbn13CheckDigit(digits));
+        } else if (digits.length() == 13) {
+            for (char c : digits) {
+                if (!isdigit(static_cast<unsigned char>(c))) return false;
+            }
+            if (isbn13CheckDigit(digits) != digits[12] - '0') return false;
+        } else {
+            return false;
+        }
+
+        key = stoull(digits);
+        return true;
+    }
+
+    // Dates are held as day numbers (days since 1970-01-01) and only
+    // formatted for display. Conversions use the proleptic Gregorian calendar.
+    int daysFromCivil(int y, int m, int d) {
+        y -= m <= 2;
+        int era = (y >= 0 ? y : y - 399) / 400;
+        int yoe = y - era * 400;
+        int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    void civilFromDays(int days, int& y, int& m, int& d) {
+        days += 719468;
+        int era = (days >= 0 ? days : days - 146096) / 146097;
+        int doe = days - era * 146097;
+        int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int mp = (5 * doy + 2) / 153;
+        d = doy - (153 * mp + 2) / 5 + 1;
+        m = mp + (mp < 10 ? 3 : -9);
+        y = yoe + era * 400 + (m <= 2);
+    }
+
+    // Flushes a closed file's contents to disk
+    bool syncFile(const string& path) {
+#ifdef _WIN32
+        int fd = _open(path.c_str(), _O_WRONLY | _O_BINARY);
+        bool synced = fd >= 0 && _commit(fd) == 0;
+        if (fd >= 0) _close(fd);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        bool synced = fd >= 0 && fsync(fd) == 0;
+        if (fd >= 0) ::close(fd);
+#endif
+        return synced;
+    }
+
+    // Makes a rename into the file's directory durable. Windows has no
+    // directory handle to sync, so there this only reports success.
+    bool syncParentDirectory(const string& path) {
+#ifdef _WIN32
+        (void)path;
+        return true;
+#else
+        size_t slash = path.find_last_of('/');
+        string directory = slash == string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+        int fd = ::open(directory.c_str(), O_RDONLY);
+        bool synced = fd >= 0 && fsync(fd) == 0;
+        if (fd >= 0) ::close(fd);
+        return synced;
+#endif
+    }
+
+    // Thread-safe replacement for localtime()
+    tm localTime(time_t time) {
+        tm result = {};
+#ifdef _WIN32
+        localtime_s(&result, &time);
+#else
+        localtime_r(&time, &result);
+#endif
+        return result;
+    }
+
+    // Local calendar day of a timestamp
+    int dayOf(time_t time) {
+        tm ltm = localTime(time);
+        return daysFromCivil(ltm.tm_year + 1900, ltm.tm_mon + 1, ltm.tm_mday);
+    }
+
+    // Timestamp of local midnight at the start of a calendar day
+    time_t startOfDay(int day) {
+        int y, m, d;
+        civilFromDays(day, y, m, d);
+        tm ltm = {};
+        ltm.tm_year = y - 1900;
+        ltm.tm_mon = m - 1;
+        ltm.tm_mday = d;
+        ltm.tm_isdst = -1;
+        return mktime(&ltm);
+    }
+
+    string formatDay(int day) {
+        int y, m, d;
+        civilFromDays(day, y, m, d);
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", y, m, d);
+        return string(buffer);
+    }
+
+    string formatTimestamp(time_t time) {
+        tm ltm = localTime(time);
+        char buffer[80];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &ltm);
+        return string(buffer);
+    }
+
+    Clock& systemClock() {
+        static SystemClock clock;
+        return clock;
+    }
+
+    atomic<Clock*>& activeClock() {
+        static atomic<Clock*> clock(&systemClock());
+        return clock;
+    }
+
+    // Installs a different time source; nullptr restores the system clock
+    void setClock(Clock* clock) {
+        activeClock() = clock ? clock : &systemClock();
+    }
+
+    time_t now() {
+        return activeClock().load()->now();
+    }
+
+    // Per-thread cache of the current time strings. They are reformatted
+    // only when the second (or, for the date, the day) changes.
+    struct ClockCache {
+        time_t second = -1;
+        int day = INT_MIN;
+        string dateTime;
+        string date;
+    };
+
+    const ClockCache& cachedNow() {
+        thread_local ClockCache cache;
+        time_t current = now();
+        if (current != cache.second) {
+            tm ltm = localTime(current);
+            char buffer[32];
+            strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &ltm);
+            cache.dateTime.assign(buffer);
+            int day = daysFromCivil(ltm.tm_year + 1900, ltm.tm_mon + 1, ltm.tm_mday);
+            if (day != cache.day) {
+                cache.date.assign(buffer, 10);
+                cache.day = day;
+            }
+            cache.second = current;
+        }
+        return cache;
+    }
+
+    // Copies out of the cache, so callers never hold a reference that the
+    // next call on this thread would overwrite
+    string getCurrentDateTime() {
+        return cachedNow().dateTime;
+    }
+
+    string getCurrentDate() {
+        return cachedNow().date;
+    }
+
+    int currentDay() {
+        return cachedNow().day;
+    }
+
+    // Parses "YYYY-MM-DD"; returns false if the text is not a date
+    bool parseDay(const string& date, int& day) {
+        int y, m, d;
+        if (sscanf(date.c_str(), "%d-%d-%d", &y, &m, &d) != 3) return false;
+        if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+        day = daysFromCivil(y, m, d);
+        return true;
     }
 
     int daysBetweenDates(const string& date1, const string& date2) {
-        tm tm1 = {}, tm2 = {};
-        istringstream iss1(date1), iss2(date2);
-        iss1 >> get_time(&tm1, "%Y-%m-%d");
-        iss2 >> get_time(&tm2, "%Y-%m-%d");
-        time_t time1 = mktime(&tm1);
-        time_t time2 = mktime(&tm2);
-        return difftime(time2, time1) / (60 * 60 * 24);
+        int day1 = 0, day2 = 0;
+        parseDay(date1, day1);
+        parseDay(date2, day2);
+        return day2 - day1;
     }
 
     string toLower(const string& str) {
@@ -108,8 +378,95 @@ namespace LibraryUtils {
         size_t last = str.find_last_not_of(" \t\n\r");
         return str.substr(first, (last - first + 1));
     }
+
+    // Splits text into lowercase alphanumeric words for the search index
+    vector<string> tokenize(const string& text) {
+        vector<string> tokens;
+        string current;
+        for (char c : text) {
+            if (isalnum(static_cast<unsigned char>(c))) {
+                current += tolower(static_cast<unsigned char>(c));
+            } else if (!current.empty()) {
+                tokens.push_back(current);
+                current.clear();
+            }
+        }
+        if (!current.empty()) tokens.push_back(current);
+        return tokens;
+    }
+
+    // Levenshtein distance, giving up early once it exceeds maxDistance
+    int editDistance(const string& a, const string& b, int maxDistance) {
+        int lengthGap = static_cast<int>(a.size()) - static_cast<int>(b.size());
+        if (abs(lengthGap) > maxDistance) return maxDistance + 1;
+
+        vector<int> prev(b.size() + 1), curr(b.size() + 1);
+        for (size_t j = 0; j <= b.size(); ++j) prev[j] = static_cast<int>(j);
+        for (size_t i = 1; i <= a.size(); ++i) {
+            curr[0] = static_cast<int>(i);
+            int rowMin = curr[0];
+            for (size_t j = 1; j <= b.size(); ++j) {
+                int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+                curr[j] = min({prev[j] + 1, curr[j - 1] + 1, prev[j - 1] + cost});
+                rowMin = min(rowMin, curr[j]);
+            }
+            if (rowMin > maxDistance) return maxDistance + 1;
+            prev.swap(curr);
+        }
+        return min(prev[b.size()], maxDistance + 1);
+    }
 }
 
+// Interned strings for metadata that repeats across the catalog (publisher,
+// language, location, edition, genre parts, tags, devices). Books hold a
+// 4-byte Symbol instead of their own string copy, and comparing two
+// symbols is an integer compare.
+typedef uint32_t Symbol;
+
+class StringPool {
+private:
+    unordered_map<string, Symbol> lookup;
+    vector<const string*> values;   // points at the keys of lookup, which never move
+    vector<Symbol> foldedIds;       // symbol of the lowercased text
+
+    static StringPool& instance() {
+        static StringPool pool;
+        return pool;
+    }
+
+    Symbol add(const string& value) {
+        auto it = lookup.find(value);
+        if (it != lookup.end()) return it->second;
+        Symbol id = static_cast<Symbol>(values.size());
+        values.push_back(&lookup.emplace(value, id).first->first);
+        foldedIds.push_back(id);
+        string lower = LibraryUtils::toLower(value);
+        if (lower != value) {
+            Symbol folded = add(lower);
+            foldedIds[id] = folded;
+        }
+        return id;
+    }
+
+public:
+    static Symbol intern(const string& value) {
+        return instance().add(value);
+    }
+
+    // Looks a string up without adding it
+    static bool find(const string& value, Symbol& id) {
+        const StringPool& pool = instance();
+        auto it = pool.lookup.find(value);
+        if (it == pool.lookup.end()) return false;
+        id = it->second;
+        return true;
+    }
+
+    static const string& text(Symbol id) { return *instance().values[id]; }
+    static Symbol folded(Symbol id) { return instance().foldedIds[id]; }
+    static size_t size() { return instance().values.size(); }
+};
+
 // Enums
 enum class BookFormat {
     HARDCOVER,
@@ -146,6 +503,281 @@ enum class NotificationType {
     GENERAL_ANNOUNCEMENT
 };
 
+enum class TransactionType : uint8_t {
+    BORROW,
+    RETURN,
+    RENEW,
+    RESERVE
+};
+
+// Binary snapshot I/O. Values are stored in native byte order behind a
+// magic/version header; the file ends with an FNV-1a checksum of every
+// byte before it. Both sides stream through a large buffer in one pass.
+// In memory mode (used for log records) symbols are written as text, so
+// a record does not depend on a pool table.
+class BinaryWriter {
+private:
+    ofstream out;
+    bool toFile;
+    vector<char> buffer;
+    size_t used;
+    uint64_t checksum;
+
+    void flushBuffer() {
+        for (size_t i = 0; i < used; ++i) {
+            checksum = (checksum ^ static_cast<unsigned char>(buffer[i])) * 0x100000001b3ULL;
+        }
+        out.write(buffer.data(), used);
+        used = 0;
+    }
+
+public:
+    explicit BinaryWriter(const string& path)
+        : out(path, ios::binary | ios::trunc), toFile(true), buffer(SNAPSHOT_BUFFER_SIZE), used(0),
+          checksum(0xcbf29ce484222325ULL) {}
+
+    // Memory mode; collect the result with bytes()
+    BinaryWriter() : toFile(false), used(0), checksum(0xcbf29ce484222325ULL) {}
+
+    bool ok() const { return !toFile || static_cast<bool>(out); }
+
+    string bytes() const { return string(buffer.data(), used); }
+
+    void writeBytes(const void* data, size_t size) {
+        if (!toFile && used + size > buffer.size()) {
+            buffer.resize(max(buffer.size() * 2, used + size));
+        }
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            if (used == buffer.size()) flushBuffer();
+            size_t chunk = min(size, buffer.size() - used);
+            memcpy(buffer.data() + used, bytes, chunk);
+            used += chunk;
+            bytes += chunk;
+            size -= chunk;
+        }
+    }
+
+    template <typename T>
+    void write(const T& value) {
+        static_assert(is_trivially_copyable<T>::value, "only plain values are written raw");
+        writeBytes(&value, sizeof(T));
+    }
+
+    void write(const string& value) {
+        write(static_cast<uint32_t>(value.size()));
+        writeBytes(value.data(), value.size());
+    }
+
+    template <typename T>
+    void write(const vector<T>& values) {
+        static_assert(is_trivially_copyable<T>::value, "only plain values are written raw");
+        write(static_cast<uint32_t>(values.size()));
+        writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void write(const vector<string>& values) {
+        write(static_cast<uint32_t>(values.size()));
+        for (const auto& value : values) write(value);
+    }
+
+    void write(const set<string>& values) {
+        write(static_cast<uint32_t>(values.size()));
+        for (const auto& value : values) write(value);
+    }
+
+    void write(const map<string, int>& values) {
+        write(static_cast<uint32_t>(values.size()));
+        for (const auto& entry : values) {
+            write(entry.first);
+            write(entry.second);
+        }
+    }
+
+    // Symbols are written as ids into the pool table at the start of the
+    // file, or as text in memory mode
+    void writeSymbol(Symbol id) {
+        if (toFile) write(id);
+        else write(StringPool::text(id));
+    }
+
+    void writeSymbols(const vector<Symbol>& ids) {
+        write(static_cast<uint32_t>(ids.size()));
+        for (Symbol id : ids) writeSymbol(id);
+    }
+
+    // Flushes, appends the checksum and closes; false on any I/O error
+    bool finish() {
+        flushBuffer();
+        out.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        out.close();
+        return !out.fail();
+    }
+};
+
+class BinaryReader {
+private:
+    ifstream in;
+    bool fromFile;
+    vector<char> buffer;
+    size_t pos;
+    size_t end;
+    uint64_t remaining;     // payload bytes not yet buffered
+    uint64_t checksum;
+    bool failed;
+    vector<Symbol> symbols; // file symbol id -> id in this process's pool
+
+    bool fill() {
+        if (remaining == 0) return false;
+        size_t chunk = static_cast<size_t>(min<uint64_t>(remaining, buffer.size()));
+        in.read(buffer.data(), chunk);
+        if (static_cast<size_t>(in.gcount()) != chunk) return false;
+        for (size_t i = 0; i < chunk; ++i) {
+            checksum = (checksum ^ static_cast<unsigned char>(buffer[i])) * 0x100000001b3ULL;
+        }
+        remaining -= chunk;
+        pos = 0;
+        end = chunk;
+        return true;
+    }
+
+    uint64_t bytesLeft() const { return remaining + (end - pos); }
+
+public:
+    // Memory mode over bytes produced by a memory-mode BinaryWriter
+    BinaryReader(const char* data, size_t size)
+        : fromFile(false), buffer(data, data + size), pos(0), end(size),
+          remaining(0), checksum(0), failed(false) {}
+
+    explicit BinaryReader(const string& path)
+        : in(path, ios::binary), fromFile(true), buffer(SNAPSHOT_BUFFER_SIZE), pos(0), end(0),
+          remaining(0), checksum(0xcbf29ce484222325ULL), failed(!in) {
+        if (failed) return;
+        in.seekg(0, ios::end);
+        streamoff size = in.tellg();
+        in.seekg(0, ios::beg);
+        if (size < static_cast<streamoff>(sizeof(uint64_t))) {
+            failed = true;
+            return;
+        }
+        remaining = static_cast<uint64_t>(size) - sizeof(uint64_t);
+    }
+
+    bool ok() const { return !failed; }
+    void fail() { failed = true; }
+
+    void readBytes(void* data, size_t size) {
+        char* bytes = static_cast<char*>(data);
+        while (size > 0) {
+            if (pos == end && (failed || !fill())) {
+                failed = true;
+                memset(bytes, 0, size);
+                return;
+            }
+            size_t chunk = min(size, end - pos);
+            memcpy(bytes, buffer.data() + pos, chunk);
+            pos += chunk;
+            bytes += chunk;
+            size -= chunk;
+        }
+    }
+
+    template <typename T>
+    void read(T& value) {
+        static_assert(is_trivially_copyable<T>::value, "only plain values are read raw");
+        readBytes(&value, sizeof(T));
+    }
+
+    // Reads an element count, rejecting counts the rest of the file cannot hold
+    uint32_t readCount(size_t minElementSize) {
+        uint32_t count = 0;
+        read(count);
+        if (static_cast<uint64_t>(count) * minElementSize > bytesLeft()) {
+            failed = true;
+            return 0;
+        }
+        return count;
+    }
+
+    void read(string& value) {
+        uint32_t size = readCount(1);
+        value.resize(size);
+        if (size > 0) readBytes(&value[0], size);
+    }
+
+    template <typename T>
+    void read(vector<T>& values) {
+        static_assert(is_trivially_copyable<T>::value, "only plain values are read raw");
+        values.resize(readCount(sizeof(T)));
+        if (!values.empty()) readBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void read(vector<string>& values) {
+        values.resize(readCount(sizeof(uint32_t)));
+        for (auto& value : values) read(value);
+    }
+
+    void read(set<string>& values) {
+        values.clear();
+        uint32_t count = readCount(sizeof(uint32_t));
+        for (uint32_t i = 0; i < count; ++i) {
+            string value;
+            read(value);
+            values.insert(move(value));
+        }
+    }
+
+    void read(map<string, int>& values) {
+        values.clear();
+        uint32_t count = readCount(sizeof(uint32_t) + sizeof(int));
+        for (uint32_t i = 0; i < count; ++i) {
+            string key;
+            read(key);
+            read(values[key]);
+        }
+    }
+
+    // Interns the pool table written at the start of the snapshot
+    void readSymbolTable() {
+        uint32_t count = readCount(sizeof(uint32_t));
+        symbols.resize(count);
+        string text;
+        for (uint32_t i = 0; i < count && !failed; ++i) {
+            read(text);
+            symbols[i] = StringPool::intern(text);
+        }
+    }
+
+    Symbol readSymbol() {
+        if (!fromFile) {
+            string text;
+            read(text);
+            return StringPool::intern(text);
+        }
+        Symbol id = 0;
+        read(id);
+        if (id >= symbols.size()) {
+            failed = true;
+            return StringPool::intern("");
+        }
+        return symbols[id];
+    }
+
+    void readSymbols(vector<Symbol>& ids) {
+        ids.resize(readCount(sizeof(uint32_t)));
+        for (Symbol& id : ids) id = readSymbol();
+    }
+
+    // True when the whole payload was consumed and the checksum matches
+    bool finish() {
+        if (failed || pos != end || remaining != 0) return false;
+        if (!fromFile) return true;
+        uint64_t stored = 0;
+        in.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+        return in.gcount() == sizeof(stored) && stored == checksum;
+    }
+};
+
 // Book class hierarchy
 class Book {
 protected:
@@ -161,14 +793,14 @@ protected:
     BookStatus status;
     vector<string> borrowHistory;
     set<string> reservedBy;
-    string publisher;
-    string language;
+    Symbol publisher;
+    Symbol language;
     string description;
-    vector<string> tags;
+    vector<Symbol> tags;
     double rating;
     int ratingCount;
-    string location;
-    string edition;
+    Symbol location;
+    Symbol edition;
     int year;
     vector<string> similarBooks;
 
@@ -177,8 +809,9 @@ public:
          string pub = "Unknown", string lang = "English", string desc = "",
          string loc = "General", string ed = "1st", int y = 0)
         : title(t), author(a), id(i), isbn(isbn), publicationDate(pubDate),
-          borrowCount(0), status(BookStatus::AVAILABLE), publisher(pub),
-          language(lang), description(desc), location(loc), edition(ed), year(y),
+          borrowCount(0), status(BookStatus::AVAILABLE), publisher(StringPool::intern(pub)),
+          language(StringPool::intern(lang)), description(desc), location(StringPool::intern(loc)),
+          edition(StringPool::intern(ed)), year(y),
           rating(0), ratingCount(0) {
         if (isbn.length() != 10 && isbn.length() != 13) {
             throw invalid_argument("ISBN must be 10 or 13 digits");
@@ -193,8 +826,59 @@ public:
         }
     }
 
+    // Snapshot constructor; reads the fields in save() order
+    explicit Book(BinaryReader& in) {
+        in.read(title);
+        in.read(author);
+        in.read(id);
+        in.read(publicationDate);
+        in.read(isbn);
+        in.read(reviews);
+        in.read(reviewAuthors);
+        in.read(reviewDates);
+        in.read(borrowCount);
+        in.read(status);
+        in.read(borrowHistory);
+        in.read(reservedBy);
+        publisher = in.readSymbol();
+        language = in.readSymbol();
+        in.read(description);
+        in.readSymbols(tags);
+        in.read(rating);
+        in.read(ratingCount);
+        location = in.readSymbol();
+        edition = in.readSymbol();
+        in.read(year);
+        in.read(similarBooks);
+    }
+
     virtual ~Book() {}
 
+    virtual void save(BinaryWriter& out) const {
+        out.write(title);
+        out.write(author);
+        out.write(id);
+        out.write(publicationDate);
+        out.write(isbn);
+        out.write(reviews);
+        out.write(reviewAuthors);
+        out.write(reviewDates);
+        out.write(borrowCount);
+        out.write(status);
+        out.write(borrowHistory);
+        out.write(reservedBy);
+        out.writeSymbol(publisher);
+        out.writeSymbol(language);
+        out.write(description);
+        out.writeSymbols(tags);
+        out.write(rating);
+        out.write(ratingCount);
+        out.writeSymbol(location);
+        out.writeSymbol(edition);
+        out.write(year);
+        out.write(similarBooks);
+    }
+
     // Pure virtual functions
     virtual void displayInfo() const = 0;
     virtual string getBookType() const = 0;
@@ -206,17 +890,28 @@ public:
     string getTitle() const { return title; }
     string getAuthor() const { return author; }
     int getId() const { return id; }
+    void setId(int i) { id = i; }
     string getISBN() const { return isbn; }
     string getPublicationDate() const { return publicationDate; }
     BookStatus getStatus() const { return status; }
     int getBorrowCount() const { return borrowCount; }
-    string getPublisher() const { return publisher; }
-    string getLanguage() const { return language; }
+    const string& getPublisher() const { return StringPool::text(publisher); }
+    const string& getLanguage() const { return StringPool::text(language); }
     string getDescription() const { return description; }
-    string getLocation() const { return location; }
-    string getEdition() const { return edition; }
+    const string& getLocation() const { return StringPool::text(location); }
+    const string& getEdition() const { return StringPool::text(edition); }
     int getYear() const { return year; }
     double getRating() const { return ratingCount > 0 ? rating / ratingCount : 0; }
+    const vector<Symbol>& getTags() const { return tags; }
+    double getRatingTotal() const { return rating; }
+    int getRatingCount() const { return ratingCount; }
+    bool isReservedBy(const string& username) const { return reservedBy.count(username) > 0; }
+    bool hasReservations() const { return !reservedBy.empty(); }
+    // First reservation holder in name order; only meaningful if hasReservations()
+    string getNextReservedUser() const { return reservedBy.empty() ? "" : *reservedBy.begin(); }
+    bool isReservedByOthers(const string& username) const {
+        return reservedBy.size() > (isReservedBy(username) ? 1u : 0u);
+    }
 
     void addReview(const string& review, const string& username, int rating) {
         if (review.length() > MAX_REVIEW_LENGTH) {
@@ -283,7 +978,7 @@ public:
             cout << "Book is not available for reservation.\n";
             return false;
         }
-        if (reservedBy.count(username) {
+        if (reservedBy.count(username)) {
             cout << "You have already reserved this book.\n";
             return false;
         }
@@ -324,9 +1019,9 @@ public:
         cout << "ID: " << id << "\n";
         cout << "ISBN: " << isbn << "\n";
         cout << "Publication Date: " << publicationDate << "\n";
-        cout << "Publisher: " << publisher << "\n";
-        cout << "Language: " << language << "\n";
-        cout << "Edition: " << edition << "\n";
+        cout << "Publisher: " << getPublisher() << "\n";
+        cout << "Language: " << getLanguage() << "\n";
+        cout << "Edition: " << getEdition() << "\n";
         cout << "Year: " << year << "\n";
         cout << "Type: " << getBookType() << "\n";
         cout << "Format: ";
@@ -351,7 +1046,7 @@ public:
         }
         cout << "\n";
         cout << "Times borrowed: " << borrowCount << "\n";
-        cout << "Location: " << location << "\n";
+        cout << "Location: " << getLocation() << "\n";
         cout << "Average Rating: " << fixed << setprecision(1) << getRating() << "/5 (" 
              << ratingCount << " ratings)\n";
         cout << "Estimated reading time: " << calculateReadingTime() << " minutes\n";
@@ -360,7 +1055,7 @@ public:
         }
         if (!tags.empty()) {
             cout << "\nTags: ";
-            for (const auto& tag : tags) cout << tag << ", ";
+            for (Symbol tag : tags) cout << StringPool::text(tag) << ", ";
             cout << "\n";
         }
         if (!reservedBy.empty()) {
@@ -374,14 +1069,17 @@ public:
     void addTag(const string& tag) {
         string trimmedTag = LibraryUtils::trim(tag);
         if (!trimmedTag.empty()) {
-            tags.push_back(trimmedTag);
+            tags.push_back(StringPool::intern(trimmedTag));
         }
     }
 
     bool hasTag(const string& tag) const {
-        string lowerTag = LibraryUtils::toLower(tag);
-        for (const auto& t : tags) {
-            if (LibraryUtils::toLower(t) == lowerTag) {
+        Symbol lowerTag;
+        if (!StringPool::find(LibraryUtils::toLower(tag), lowerTag)) {
+            return false;
+        }
+        for (Symbol t : tags) {
+            if (StringPool::folded(t) == lowerTag) {
                 return true;
             }
         }
@@ -393,14 +1091,14 @@ public:
     }
 
     void setLocation(const string& loc) {
-        location = loc;
+        location = StringPool::intern(loc);
     }
 };
 
 // Derived Book Classes
 class FictionBook : public Book {
 protected:
-    string subgenre;
+    Symbol subgenre;
     bool isSeries;
     string seriesName;
     int seriesNumber;
@@ -411,16 +1109,31 @@ public:
                 string desc = "", string loc = "Fiction", string ed = "1st", int y = 0,
                 bool series = false, string sName = "", int sNum = 0)
         : Book(t, a, i, isbn, pubDate, pub, lang, desc, loc, ed, y),
-          subgenre(subg), isSeries(series), seriesName(sName), seriesNumber(sNum) {}
+          subgenre(StringPool::intern(subg)), isSeries(series), seriesName(sName), seriesNumber(sNum) {}
+
+    explicit FictionBook(BinaryReader& in) : Book(in) {
+        subgenre = in.readSymbol();
+        in.read(isSeries);
+        in.read(seriesName);
+        in.read(seriesNumber);
+    }
+
+    void save(BinaryWriter& out) const override {
+        Book::save(out);
+        out.writeSymbol(subgenre);
+        out.write(isSeries);
+        out.write(seriesName);
+        out.write(seriesNumber);
+    }
 
-    string getSubgenre() const { return subgenre; }
+    const string& getSubgenre() const { return StringPool::text(subgenre); }
     bool getIsSeries() const { return isSeries; }
     string getSeriesName() const { return seriesName; }
     int getSeriesNumber() const { return seriesNumber; }
 
     void printDetailedInfo() const override {
         Book::printDetailedInfo();
-        cout << "Subgenre: " << subgenre << "\n";
+        cout << "Subgenre: " << getSubgenre() << "\n";
         if (isSeries) {
             cout << "Part of series: " << seriesName << " (Book #" << seriesNumber << ")\n";
         }
@@ -429,8 +1142,8 @@ public:
 
 class NonFictionBook : public Book {
 protected:
-    string subject;
-    string classification;
+    Symbol subject;
+    Symbol classification;
 
 public:
     NonFictionBook(string t, string a, int i, string isbn, string pubDate, 
@@ -438,15 +1151,26 @@ public:
                    string lang = "English", string desc = "", 
                    string loc = "Non-Fiction", string ed = "1st", int y = 0)
         : Book(t, a, i, isbn, pubDate, pub, lang, desc, loc, ed, y),
-          subject(subj), classification(cls) {}
+          subject(StringPool::intern(subj)), classification(StringPool::intern(cls)) {}
+
+    explicit NonFictionBook(BinaryReader& in) : Book(in) {
+        subject = in.readSymbol();
+        classification = in.readSymbol();
+    }
+
+    void save(BinaryWriter& out) const override {
+        Book::save(out);
+        out.writeSymbol(subject);
+        out.writeSymbol(classification);
+    }
 
-    string getSubject() const { return subject; }
-    string getClassification() const { return classification; }
+    const string& getSubject() const { return StringPool::text(subject); }
+    const string& getClassification() const { return StringPool::text(classification); }
 
     void printDetailedInfo() const override {
         Book::printDetailedInfo();
-        cout << "Subject: " << subject << "\n";
-        cout << "Classification: " << classification << "\n";
+        cout << "Subject: " << getSubject() << "\n";
+        cout << "Classification: " << getClassification() << "\n";
     }
 };
 
@@ -457,7 +1181,14 @@ private:
     int wordCount;
     bool drmProtected;
     string downloadLink;
-    vector<string> compatibleDevices;
+    shared_ptr<const vector<Symbol>> compatibleDevices;   // shared until modified
+
+    static const shared_ptr<const vector<Symbol>>& defaultDevices() {
+        static const shared_ptr<const vector<Symbol>> devices = make_shared<const vector<Symbol>>(
+            vector<Symbol>{StringPool::intern("Computer"), StringPool::intern("Tablet"),
+                           StringPool::intern("Smartphone"), StringPool::intern("E-reader")});
+        return devices;
+    }
 
 public:
     EBook(string t, string a, int i, string isbn, string pubDate, 
@@ -466,8 +1197,31 @@ public:
           string desc = "", string loc = "Digital", string ed = "1st", int y = 0)
         : Book(t, a, i, isbn, pubDate, pub, lang, desc, loc, ed, y),
           format(f), fileSizeMB(size), wordCount(words), drmProtected(drm),
-          downloadLink(link) {
-        compatibleDevices = {"Computer", "Tablet", "Smartphone", "E-reader"};
+          downloadLink(link), compatibleDevices(defaultDevices()) {}
+
+    explicit EBook(BinaryReader& in) : Book(in) {
+        in.read(format);
+        in.read(fileSizeMB);
+        in.read(wordCount);
+        in.read(drmProtected);
+        in.read(downloadLink);
+        vector<Symbol> devices;
+        in.readSymbols(devices);
+        if (devices == *defaultDevices()) {
+            compatibleDevices = defaultDevices();
+        } else {
+            compatibleDevices = make_shared<const vector<Symbol>>(move(devices));
+        }
+    }
+
+    void save(BinaryWriter& out) const override {
+        Book::save(out);
+        out.write(format);
+        out.write(fileSizeMB);
+        out.write(wordCount);
+        out.write(drmProtected);
+        out.write(downloadLink);
+        out.writeSymbols(*compatibleDevices);
     }
 
     void displayInfo() const override {
@@ -483,6 +1237,11 @@ public:
         cout << "  ISBN: " << isbn << " | Published: " << publicationDate << "\n";
     }
 
+    double getFileSizeMB() const { return fileSizeMB; }
+    int getWordCount() const { return wordCount; }
+    bool getDrmProtected() const { return drmProtected; }
+    const string& getDownloadLink() const { return downloadLink; }
+
     string getBookType() const override { return "E-Book"; }
     string getGenre() const override { return "Digital"; }
     BookFormat getFormat() const override { return format; }
@@ -509,7 +1268,7 @@ public:
             cout << "Download Link: " << downloadLink << "\n";
         }
         cout << "Compatible Devices: ";
-        for (const auto& device : compatibleDevices) cout << device << ", ";
+        for (Symbol device : *compatibleDevices) cout << StringPool::text(device) << ", ";
         cout << "\n";
     }
 
@@ -518,7 +1277,9 @@ public:
     }
 
     void addCompatibleDevice(const string& device) {
-        compatibleDevices.push_back(device);
+        auto devices = make_shared<vector<Symbol>>(*compatibleDevices);
+        devices->push_back(StringPool::intern(device));
+        compatibleDevices = devices;
     }
 };
 
@@ -542,6 +1303,27 @@ public:
           format(f), pages(p), bindingType(binding), dimensions(dim), weight(w),
           hasIllustrations(illus), condition(cond) {}
 
+    explicit PrintedBook(BinaryReader& in) : Book(in) {
+        in.read(format);
+        in.read(pages);
+        in.read(bindingType);
+        in.read(dimensions);
+        in.read(weight);
+        in.read(hasIllustrations);
+        in.read(condition);
+    }
+
+    void save(BinaryWriter& out) const override {
+        Book::save(out);
+        out.write(format);
+        out.write(pages);
+        out.write(bindingType);
+        out.write(dimensions);
+        out.write(weight);
+        out.write(hasIllustrations);
+        out.write(condition);
+    }
+
     void displayInfo() const override {
         cout << "[Printed Book] " << title << " by " << author << "\n";
         cout << "  Format: ";
@@ -554,6 +1336,13 @@ public:
         cout << "  ISBN: " << isbn << " | Published: " << publicationDate << "\n";
     }
 
+    int getPages() const { return pages; }
+    const string& getBindingType() const { return bindingType; }
+    const string& getDimensions() const { return dimensions; }
+    double getWeight() const { return weight; }
+    bool getHasIllustrations() const { return hasIllustrations; }
+    const string& getCondition() const { return condition; }
+
     string getBookType() const override { return "Printed Book"; }
     string getGenre() const override { return "Physical"; }
     BookFormat getFormat() const override { return format; }
@@ -604,9 +1393,22 @@ public:
                      series, sName, sNum),
           hasMagicSystem(magic), worldName(world) {}
 
+    explicit FantasyNovel(BinaryReader& in) : FictionBook(in) {
+        in.read(hasMagicSystem);
+        in.read(worldName);
+        in.read(magicalCreatures);
+    }
+
+    void save(BinaryWriter& out) const override {
+        FictionBook::save(out);
+        out.write(hasMagicSystem);
+        out.write(worldName);
+        out.write(magicalCreatures);
+    }
+
     void displayInfo() const override {
         cout << "[Fantasy Novel] " << getTitle() << " by " << getAuthor() << "\n";
-        cout << "  Subgenre: " << subgenre;
+        cout << "  Subgenre: " << getSubgenre();
         if (isSeries) {
             cout << " | Series: " << seriesName << " #" << seriesNumber;
         }
@@ -616,13 +1418,17 @@ public:
         cout << "\n";
     }
 
+    bool getHasMagicSystem() const { return hasMagicSystem; }
+    const string& getWorldName() const { return worldName; }
+
     string getBookType() const override { return "Fantasy Novel"; }
-    string getGenre() const override { return "Fantasy/" + subgenre; }
+    string getGenre() const override { return "Fantasy/" + getSubgenre(); }
     BookFormat getFormat() const override { return BookFormat::PAPERBACK; }
     
     int calculateReadingTime() const override {
-        // Fantasy novels might take longer to read
-        return pages * 3;
+        // Fantasy novels might take longer to read; no page count is
+        // stored, so assume a typical 400-page novel
+        return 400 * 3;
     }
 
     void printDetailedInfo() const override {
@@ -649,7 +1455,7 @@ public:
 
 class ScienceTextbook : public NonFictionBook {
 private:
-    string field;
+    Symbol field;
     int editionYear;
     vector<string> authors;
     bool hasExercises;
@@ -662,7 +1468,7 @@ public:
                     string desc = "", string loc = "Textbooks", string ed = "1st",
                     int y = 0, bool exercises = true, string code = "")
         : NonFictionBook(t, a, i, isbn, pubDate, subj, cls, pub, lang, desc, loc, ed, y),
-          field(field), editionYear(edYear), hasExercises(exercises), courseCode(code) {
+          field(StringPool::intern(field)), editionYear(edYear), hasExercises(exercises), courseCode(code) {
         // Split multiple authors if separated by commas
         size_t pos = 0;
         string token;
@@ -675,9 +1481,26 @@ public:
         authors.push_back(LibraryUtils::trim(authorsStr));
     }
 
+    explicit ScienceTextbook(BinaryReader& in) : NonFictionBook(in) {
+        field = in.readSymbol();
+        in.read(editionYear);
+        in.read(authors);
+        in.read(hasExercises);
+        in.read(courseCode);
+    }
+
+    void save(BinaryWriter& out) const override {
+        NonFictionBook::save(out);
+        out.writeSymbol(field);
+        out.write(editionYear);
+        out.write(authors);
+        out.write(hasExercises);
+        out.write(courseCode);
+    }
+
     void displayInfo() const override {
         cout << "[Science Textbook] " << title << "\n";
-        cout << "  Field: " << field << " | Subject: " << subject << "\n";
+        cout << "  Field: " << StringPool::text(field) << " | Subject: " << getSubject() << "\n";
         cout << "  Authors: ";
         for (size_t i = 0; i < authors.size(); ++i) {
             if (i > 0) cout << ", ";
@@ -686,18 +1509,25 @@ public:
         cout << "\n";
     }
 
+    const vector<string>& getAuthors() const { return authors; }
+    const string& getField() const { return StringPool::text(field); }
+    int getEditionYear() const { return editionYear; }
+    bool getHasExercises() const { return hasExercises; }
+    string getCourseCode() const { return courseCode; }
+
     string getBookType() const override { return "Science Textbook"; }
-    string getGenre() const override { return "Education/" + field; }
+    string getGenre() const override { return "Education/" + StringPool::text(field); }
     BookFormat getFormat() const override { return BookFormat::HARDCOVER; }
     
     int calculateReadingTime() const override {
-        // Textbooks take longer per page
-        return pages * 5;
+        // Textbooks take longer per page; no page count is stored, so
+        // assume a typical 600-page textbook
+        return 600 * 5;
     }
 
     void printDetailedInfo() const override {
         NonFictionBook::printDetailedInfo();
-        cout << "Field: " << field << "\n";
+        cout << "Field: " << StringPool::text(field) << "\n";
         cout << "Edition Year: " << editionYear << "\n";
         cout << "Authors: ";
         for (size_t i = 0; i < authors.size(); ++i) {
@@ -720,370 +1550,2516 @@ public:
     }
 };
 
-// Transaction class
-class Transaction {
-private:
-    int transactionId;
-    string username;
-    int bookId;
-    string transactionDate;
-    string dueDate;
-    string returnDate;
-    double lateFee;
-    bool isReturned;
-    string transactionType; // "borrow", "return", "renew", "reserve"
+// Snapshot records start with the concrete type of the book
+enum class SnapshotBookKind : uint8_t {
+    EBOOK,
+    PRINTED_BOOK,
+    FANTASY_NOVEL,
+    SCIENCE_TEXTBOOK
+};
 
-public:
-    Transaction(int id, string user, int book, string type, 
-                string date = "", string due = "")
-        : transactionId(id), username(user), bookId(book), transactionType(type),
-          lateFee(0.0), isReturned(false) {
-        transactionDate = date.empty() ? LibraryUtils::getCurrentDateTime() : date;
-        
-        if (type == "borrow") {
-            int days = MAX_BORROW_DAYS;
-            dueDate = due.empty() ? LibraryUtils::getCurrentDate() : due;
-            // Add days to due date (simplified)
-            dueDate = LibraryUtils::getCurrentDate(); // This should be properly calculated
-        }
+// Returns false, writing nothing, for a book type loadBook cannot rebuild
+bool saveBook(BinaryWriter& out, const Book& book) {
+    SnapshotBookKind kind;
+    if (dynamic_cast<const FantasyNovel*>(&book)) kind = SnapshotBookKind::FANTASY_NOVEL;
+    else if (dynamic_cast<const ScienceTextbook*>(&book)) kind = SnapshotBookKind::SCIENCE_TEXTBOOK;
+    else if (dynamic_cast<const EBook*>(&book)) kind = SnapshotBookKind::EBOOK;
+    else if (dynamic_cast<const PrintedBook*>(&book)) kind = SnapshotBookKind::PRINTED_BOOK;
+    else return false;
+    out.write(kind);
+    book.save(out);
+    return true;
+}
+
+// Returns nullptr (and marks the reader failed) on an unknown record type
+unique_ptr<Book> loadBook(BinaryReader& in) {
+    SnapshotBookKind kind;
+    in.read(kind);
+    switch (kind) {
+        case SnapshotBookKind::EBOOK: return make_unique<EBook>(in);
+        case SnapshotBookKind::PRINTED_BOOK: return make_unique<PrintedBook>(in);
+        case SnapshotBookKind::FANTASY_NOVEL: return make_unique<FantasyNovel>(in);
+        case SnapshotBookKind::SCIENCE_TEXTBOOK: return make_unique<ScienceTextbook>(in);
     }
+    in.fail();
+    return nullptr;
+}
 
-    void calculateLateFee() {
-        if (isReturned || transactionType != "borrow") return;
-        
-        string currentDate = LibraryUtils::getCurrentDate();
-        int daysLate = LibraryUtils::daysBetweenDates(dueDate, currentDate);
-        
-        if (daysLate > 0) {
-            lateFee = daysLate * LATE_FEE_PER_DAY;
+// Catalog indexes
+class InvertedIndex {
+public:
+    enum Field { TITLE, AUTHOR, DESCRIPTION, TAGS, FIELD_COUNT };
+
+private:
+    struct Posting {
+        int bookId;
+        uint16_t termFreq[FIELD_COUNT];
+    };
+
+    struct DocEntry {
+        vector<string> terms;
+        uint32_t length[FIELD_COUNT];
+    };
+
+    map<string, vector<Posting>> postings;      // term -> postings sorted by book ID
+    unordered_map<int, DocEntry> docs;
+    uint64_t totalLength[FIELD_COUNT] = {};
+
+    static constexpr double FIELD_WEIGHTS[FIELD_COUNT] = {3.0, 2.0, 1.0, 1.5};
+
+    static bool postingBefore(const Posting& p, int id) { return p.bookId < id; }
+
+    static vector<int> intersect(const vector<int>& ids, const vector<Posting>& list) {
+        vector<int> result;
+        size_t i = 0, j = 0;
+        while (i < ids.size() && j < list.size()) {
+            if (ids[i] < list[j].bookId) ++i;
+            else if (list[j].bookId < ids[i]) ++j;
+            else { result.push_back(ids[i]); ++i; ++j; }
         }
+        return result;
     }
 
-    void markReturned(string date = "") {
-        returnDate = date.empty() ? LibraryUtils::getCurrentDateTime() : date;
-        isReturned = true;
-        calculateLateFee();
+    // Union of the posting lists whose term starts with prefix, merged in
+    // one pass through a min-heap of list heads
+    vector<int> prefixPostings(const string& prefix) const {
+        vector<const vector<Posting>*> lists;
+        for (auto it = postings.lower_bound(prefix);
+             it != postings.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+            lists.push_back(&it->second);
+        }
+        if (lists.empty()) return {};
+        if (lists.size() == 1) {
+            vector<int> ids;
+            ids.reserve(lists[0]->size());
+            for (const Posting& p : *lists[0]) ids.push_back(p.bookId);
+            return ids;
+        }
+
+        // (book ID, list) of each list's next posting, smallest ID on top
+        typedef pair<int, size_t> Head;
+        priority_queue<Head, vector<Head>, greater<Head>> heads;
+        vector<size_t> next(lists.size(), 0);
+        size_t longest = 0;
+        for (size_t l = 0; l < lists.size(); ++l) {
+            heads.push({lists[l]->front().bookId, l});
+            longest = max(longest, lists[l]->size());
+        }
+        vector<int> result;
+        result.reserve(longest);
+        while (!heads.empty()) {
+            Head head = heads.top();
+            heads.pop();
+            if (result.empty() || result.back() != head.first) result.push_back(head.first);
+            const vector<Posting>& list = *lists[head.second];
+            if (++next[head.second] < list.size()) heads.push({list[next[head.second]].bookId, head.second});
+        }
+        return result;
     }
 
-    void displayInfo() const {
-        cout << "Transaction #" << transactionId << " (" << transactionType << ")\n";
-        cout << "----------------------------------------\n";
-        cout << "User: " << username << "\n";
-        cout << "Book ID: " << bookId << "\n";
-        cout << "Date: " << transactionDate << "\n";
-        if (transactionType == "borrow") {
-            cout << "Due Date: " << dueDate << "\n";
-            cout << "Returned: " << (isReturned ? "Yes" : "No") << "\n";
-            if (isReturned) {
-                cout << "Return Date: " << returnDate << "\n";
-                if (lateFee > 0) {
-                    cout << "Late Fee: $" << fixed << setprecision(2) << lateFee << "\n";
-                }
+public:
+    void add(const Book* book) {
+        map<string, Posting> counts;
+        DocEntry entry = {};
+        auto countField = [&](const string& text, Field field) {
+            for (auto& token : LibraryUtils::tokenize(text)) {
+                Posting& p = counts[token];
+                if (p.termFreq[field] < UINT16_MAX) p.termFreq[field]++;
+                entry.length[field]++;
             }
-        }
-        cout << "----------------------------------------\n";
+        };
+        countField(book->getTitle(), TITLE);
+        countField(book->getAuthor(), AUTHOR);
+        countField(book->getDescription(), DESCRIPTION);
+        for (Symbol tag : book->getTags()) countField(StringPool::text(tag), TAGS);
+
+        for (auto& pair : counts) {
+            Posting posting = pair.second;
+            posting.bookId = book->getId();
+            vector<Posting>& list = postings[pair.first];
+            auto it = lower_bound(list.begin(), list.end(), posting.bookId, postingBefore);
+            if (it != list.end() && it->bookId == posting.bookId) *it = posting;
+            else list.insert(it, posting);
+            entry.terms.push_back(pair.first);
+        }
+        for (int f = 0; f < FIELD_COUNT; ++f) totalLength[f] += entry.length[f];
+        docs[book->getId()] = move(entry);
     }
 
-    int getId() const { return transactionId; }
-    string getUsername() const { return username; }
-    int getBookId() const { return bookId; }
-    string getType() const { return transactionType; }
-    string getDueDate() const { return dueDate; }
-    double getLateFee() const { return lateFee; }
-    bool getIsReturned() const { return isReturned; }
-
-    void renew(int additionalDays) {
-        if (transactionType != "borrow" || isReturned) return;
-        
-        // Simplified date calculation
-        dueDate = LibraryUtils::getCurrentDate(); // Should properly add days
-        cout << "Transaction #" << transactionId << " renewed. New due date: " 
-             << dueDate << "\n";
+    void remove(int bookId) {
+        auto it = docs.find(bookId);
+        if (it == docs.end()) return;
+        for (const auto& term : it->second.terms) {
+            auto posting = postings.find(term);
+            if (posting == postings.end()) continue;
+            vector<Posting>& list = posting->second;
+            auto pos = lower_bound(list.begin(), list.end(), bookId, postingBefore);
+            if (pos != list.end() && pos->bookId == bookId) list.erase(pos);
+            if (list.empty()) postings.erase(posting);
+        }
+        for (int f = 0; f < FIELD_COUNT; ++f) totalLength[f] -= it->second.length[f];
+        docs.erase(it);
     }
-};
-
-// Notification System
-class NotificationSystem {
-private:
-    struct Notification {
-        int id;
-        string recipient;
-        string message;
-        string date;
-        NotificationType type;
-        bool isRead;
-    };
-
-    vector<Notification> notifications;
-    int nextId;
-
-public:
-    NotificationSystem() : nextId(1) {}
 
-    void sendNotification(const string& recipient, const string& message, 
-                         NotificationType type) {
-        notifications.push_back({
-            nextId++,
-            recipient,
-            message,
-            LibraryUtils::getCurrentDateTime(),
-            type,
-            false
-        });
+    // Books containing every query word; the last word also matches as a
+    // prefix so partially typed queries still find results. One or two
+    // letters would expand to most of the vocabulary, so below
+    // MIN_PREFIX_LENGTH the last word must match whole like the others.
+    vector<int> search(const string& query) const {
+        vector<string> tokens = LibraryUtils::tokenize(query);
+        if (tokens.empty()) return {};
+
+        string last = tokens.back();
+        tokens.pop_back();
+        if (last.size() < MIN_PREFIX_LENGTH) {
+            tokens.push_back(last);
+            last.clear();
+        }
+        sort(tokens.begin(), tokens.end());
+        tokens.erase(unique(tokens.begin(), tokens.end()), tokens.end());
+
+        vector<const vector<Posting>*> lists;
+        for (const auto& token : tokens) {
+            auto it = postings.find(token);
+            if (it == postings.end()) return {};
+            lists.push_back(&it->second);
+        }
+        if (lists.empty()) return prefixPostings(last);
+        sort(lists.begin(), lists.end(),
+            [](const vector<Posting>* a, const vector<Posting>* b) { return a->size() < b->size(); });
+
+        vector<int> result;
+        result.reserve(lists[0]->size());
+        for (const Posting& p : *lists[0]) result.push_back(p.bookId);
+        for (size_t l = 1; l < lists.size() && !result.empty(); ++l) {
+            result = intersect(result, *lists[l]);
+        }
+        if (last.empty() || result.empty()) return result;
+
+        // The partly typed word: if its completions are few and short next
+        // to the candidates, merge them and intersect; otherwise check each
+        // candidate's own sorted terms
+        size_t completions = 0, completionPostings = 0;
+        for (auto it = postings.lower_bound(last);
+             it != postings.end() && it->first.compare(0, last.size(), last) == 0; ++it) {
+            completionPostings += it->second.size();
+            if (++completions > MAX_PREFIX_TERMS || completionPostings > result.size()) break;
+        }
+        if (completions <= MAX_PREFIX_TERMS && completionPostings <= result.size()) {
+            vector<int> prefixed = prefixPostings(last);
+            vector<int> both;
+            set_intersection(result.begin(), result.end(), prefixed.begin(), prefixed.end(), back_inserter(both));
+            return both;
+        }
+        result.erase(remove_if(result.begin(), result.end(), [&](int id) {
+            const vector<string>& terms = docs.at(id).terms;
+            auto it = lower_bound(terms.begin(), terms.end(), last);
+            return it == terms.end() || it->compare(0, last.size(), last) != 0;
+        }), result.end());
+        return result;
     }
 
-    void markAsRead(int notificationId) {
-        for (auto& note : notifications) {
-            if (note.id == notificationId) {
-                note.isRead = true;
-                break;
+    // BM25F relevance ranking over the query words. Only the top k books are
+    // kept, in a bounded min-heap, so hits below page one are never sorted.
+    vector<pair<int, double>> rank(const string& query, size_t k) const {
+        vector<string> tokens = LibraryUtils::tokenize(query);
+        sort(tokens.begin(), tokens.end());
+        tokens.erase(unique(tokens.begin(), tokens.end()), tokens.end());
+        if (tokens.empty() || k == 0 || docs.empty()) return {};
+
+        double docCount = static_cast<double>(docs.size());
+        double avgLength[FIELD_COUNT];
+        for (int f = 0; f < FIELD_COUNT; ++f) {
+            avgLength[f] = max(1.0, totalLength[f] / docCount);
+        }
+
+        unordered_map<int, double> scores;
+        for (const auto& token : tokens) {
+            auto it = postings.find(token);
+            if (it == postings.end()) continue;
+            double df = static_cast<double>(it->second.size());
+            double idf = log(1.0 + (docCount - df + 0.5) / (df + 0.5));
+            for (const Posting& p : it->second) {
+                const DocEntry& doc = docs.at(p.bookId);
+                double weighted = 0;
+                for (int f = 0; f < FIELD_COUNT; ++f) {
+                    if (p.termFreq[f] == 0) continue;
+                    double norm = 1.0 - BM25_B + BM25_B * doc.length[f] / avgLength[f];
+                    weighted += FIELD_WEIGHTS[f] * p.termFreq[f] / norm;
+                }
+                scores[p.bookId] += idf * weighted / (BM25_K1 + weighted);
             }
         }
-    }
 
-    vector<Notification> getUnreadNotifications(const string& username) const {
-        vector<Notification> unread;
-        for (const auto& note : notifications) {
-            if (note.recipient == username && !note.isRead) {
-                unread.push_back(note);
+        // Worse results sit on top of the heap: lower score, then higher ID
+        auto worse = [](const pair<int, double>& a, const pair<int, double>& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        };
+        priority_queue<pair<int, double>, vector<pair<int, double>>, decltype(worse)> heap(worse);
+        for (const auto& entry : scores) {
+            if (heap.size() < k) {
+                heap.push(entry);
+            } else if (worse(entry, heap.top())) {
+                heap.pop();
+                heap.push(entry);
             }
         }
-        return unread;
+
+        vector<pair<int, double>> ranked(heap.size());
+        for (size_t i = ranked.size(); i-- > 0; ) {
+            ranked[i] = heap.top();
+            heap.pop();
+        }
+        return ranked;
     }
+};
 
-    vector<Notification> getAllNotifications(const string& username) const {
-        vector<Notification> userNotes;
-        for (const auto& note : notifications) {
-            if (note.recipient == username) {
-                userNotes.push_back(note);
+// Trigram index over title and author words for typo-tolerant lookups
+class TrigramIndex {
+private:
+    unordered_map<uint32_t, vector<int>> postings;   // trigram -> sorted book IDs
+    unordered_map<int, vector<string>> wordsByBook;
+
+    static const size_t MAX_VERIFIED = 2048;            // edit-distance checks per query
+    static const size_t MAX_MERGED_POSTINGS = 20000;    // above this, overlaps are counted instead
+
+    // Each word is padded with '$' so prefixes and suffixes get their own grams
+    static vector<uint32_t> trigrams(const vector<string>& words) {
+        vector<uint32_t> grams;
+        for (const auto& word : words) {
+            string padded = "$" + word + "$";
+            for (size_t i = 0; i + 3 <= padded.size(); ++i) {
+                grams.push_back((static_cast<uint32_t>(static_cast<unsigned char>(padded[i])) << 16) |
+                                (static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8) |
+                                 static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 2])));
             }
         }
-        return userNotes;
+        sort(grams.begin(), grams.end());
+        grams.erase(unique(grams.begin(), grams.end()), grams.end());
+        return grams;
     }
 
-    void displayNotifications(const string& username) const {
-        auto userNotes = getAllNotifications(username);
-        if (userNotes.empty()) {
-            cout << "No notifications found.\n";
-            return;
+    // Typos allowed per query word, scaled by its length
+    static int allowedEdits(const string& word) {
+        if (word.size() <= 2) return 0;
+        if (word.size() <= 5) return 1;
+        return 2;
+    }
+
+public:
+    void add(const Book* book) {
+        vector<string> words = LibraryUtils::tokenize(book->getTitle());
+        for (auto& word : LibraryUtils::tokenize(book->getAuthor())) words.push_back(move(word));
+        int id = book->getId();
+        for (uint32_t gram : trigrams(words)) {
+            vector<int>& ids = postings[gram];
+            auto it = lower_bound(ids.begin(), ids.end(), id);
+            if (it == ids.end() || *it != id) ids.insert(it, id);
+        }
+        wordsByBook[id] = move(words);
+    }
+
+    void remove(int bookId) {
+        auto it = wordsByBook.find(bookId);
+        if (it == wordsByBook.end()) return;
+        for (uint32_t gram : trigrams(it->second)) {
+            auto posting = postings.find(gram);
+            if (posting == postings.end()) continue;
+            vector<int>& ids = posting->second;
+            auto pos = lower_bound(ids.begin(), ids.end(), bookId);
+            if (pos != ids.end() && *pos == bookId) ids.erase(pos);
+            if (ids.empty()) postings.erase(posting);
+        }
+        wordsByBook.erase(it);
+    }
+
+    // Books are ranked by edit distance; every query word must match some
+    // title/author word within its typo budget.
+    //
+    // Each edit breaks at most three trigrams, so a book at total distance
+    // d shares at least (grams - 3 * d) of the query's grams, and a match
+    // shares at least `required` of them. A match must therefore appear in
+    // one of the shortest (lists - required + 1) posting lists. When those
+    // lists are short they are merged and the rest are binary-searched;
+    // when they are long (common grams only), every list is counted into a
+    // dense per-book array. Candidates are then verified in order of
+    // overlap until none left can beat the best `limit` found so far, or
+    // MAX_VERIFIED checks have been spent on the closest ones.
+    vector<int> search(const string& query, size_t limit) const {
+        vector<string> queryWords = LibraryUtils::tokenize(query);
+        if (queryWords.empty() || limit == 0) return {};
+
+        vector<uint32_t> grams = trigrams(queryWords);
+        size_t brokenGrams = 0;
+        for (const auto& word : queryWords) brokenGrams += 3 * allowedEdits(word);
+        size_t required = grams.size() > brokenGrams ? grams.size() - brokenGrams : 1;
+
+        vector<const vector<int>*> lists;
+        for (uint32_t gram : grams) {
+            auto it = postings.find(gram);
+            if (it != postings.end()) lists.push_back(&it->second);
+        }
+        if (lists.empty()) return {};
+        sort(lists.begin(), lists.end(),
+             [](const vector<int>* a, const vector<int>* b) { return a->size() < b->size(); });
+
+        size_t toScan = lists.size() >= required ? lists.size() - required + 1 : lists.size();
+        size_t mergedPostings = 0;
+        for (size_t i = 0; i < toScan; ++i) mergedPostings += lists[i]->size();
+
+        vector<pair<int, int>> candidates;     // book ID, shared trigrams
+        size_t scanned;                        // lists already counted into candidates
+        if (mergedPostings <= MAX_MERGED_POSTINGS) {
+            vector<int> ids;
+            ids.reserve(mergedPostings);
+            for (scanned = 0; scanned < toScan; ++scanned) {
+                size_t middle = ids.size();
+                ids.insert(ids.end(), lists[scanned]->begin(), lists[scanned]->end());
+                inplace_merge(ids.begin(), ids.begin() + middle, ids.end());
+            }
+            for (size_t i = 0; i < ids.size(); ) {
+                size_t j = i;
+                while (j < ids.size() && ids[j] == ids[i]) ++j;
+                candidates.emplace_back(ids[i], static_cast<int>(j - i));
+                i = j;
+            }
+        } else {
+            int maxId = 0;
+            for (const auto* list : lists) maxId = max(maxId, list->back());
+            vector<uint16_t> overlap(static_cast<size_t>(maxId) + 1);
+            for (const auto* list : lists) {
+                for (int id : *list) overlap[id]++;
+            }
+            for (int id = 0; id <= maxId; ++id) {
+                if (overlap[id] >= required) candidates.emplace_back(id, overlap[id]);
+            }
+            scanned = lists.size();
         }
 
-        cout << "Notifications for " << username << ":\n";
-        cout << "----------------------------------------\n";
-        for (const auto& note : userNotes) {
-            cout << "[" << note.date << "] ";
-            switch (note.type) {
-                case NotificationType::DUE_DATE_REMINDER: cout << "REMINDER: "; break;
-                case NotificationType::OVERDUE_NOTICE: cout << "OVERDUE: "; break;
-                case NotificationType::RESERVATION_AVAILABLE: cout << "RESERVATION: "; break;
-                case NotificationType::NEW_BOOK_ARRIVAL: cout << "NEW BOOK: "; break;
-                case NotificationType::GENERAL_ANNOUNCEMENT: cout << "ANNOUNCEMENT: "; break;
-            }
-            cout << note.message << "\n";
-            cout << (note.isRead ? "(read)" : "(new)") << "\n\n";
+        // Bucket by overlap; IDs stay ascending within a bucket
+        vector<vector<int>> byOverlap(grams.size() + 1);
+        for (auto& candidate : candidates) {
+            for (size_t i = scanned; i < lists.size(); ++i) {
+                if (binary_search(lists[i]->begin(), lists[i]->end(), candidate.first)) candidate.second++;
+            }
+            if (candidate.second >= static_cast<int>(required)) byOverlap[candidate.second].push_back(candidate.first);
         }
-        cout << "----------------------------------------\n";
-    }
 
-    void checkDueDates(const vector<Transaction>& transactions) {
-        string today = LibraryUtils::getCurrentDate();
-        for (const auto& trans : transactions) {
-            if (trans.getType() == "borrow" && !trans.getIsReturned()) {
-                int daysRemaining = LibraryUtils::daysBetweenDates(today, trans.getDueDate());
-                
-                if (daysRemaining == 1) {
-                    sendNotification(trans.getUsername(), 
-                        "Your borrowed book (ID: " + to_string(trans.getBookId()) + 
-                        ") is due tomorrow.", NotificationType::DUE_DATE_REMINDER);
-                } else if (daysRemaining < 0) {
-                    sendNotification(trans.getUsername(), 
-                        "Your borrowed book (ID: " + to_string(trans.getBookId()) + 
-                        ") is overdue by " + to_string(-daysRemaining) + " days.", 
-                        NotificationType::OVERDUE_NOTICE);
+        struct Match { int distance; int overlap; int bookId; };
+        auto ranksBefore = [](const Match& a, const Match& b) {
+            if (a.distance != b.distance) return a.distance < b.distance;
+            if (a.overlap != b.overlap) return a.overlap > b.overlap;
+            return a.bookId < b.bookId;
+        };
+        vector<Match> matches;     // best `limit` so far, in rank order
+        size_t verified = 0;
+        for (size_t shared = grams.size(); shared >= required && verified < MAX_VERIFIED; --shared) {
+            int closestPossible = static_cast<int>((grams.size() - shared + 2) / 3);
+            for (int bookId : byOverlap[shared]) {
+                if (matches.size() == limit && closestPossible >= matches.back().distance) break;
+                if (verified++ == MAX_VERIFIED) break;
+                const vector<string>& words = wordsByBook.at(bookId);
+                int total = 0;
+                bool accepted = true;
+                for (const auto& queryWord : queryWords) {
+                    int budget = allowedEdits(queryWord);
+                    int best = budget + 1;
+                    for (const auto& word : words) {
+                        best = min(best, LibraryUtils::editDistance(queryWord, word, budget));
+                        if (best == 0) break;
+                    }
+                    if (best > budget) {
+                        accepted = false;
+                        break;
+                    }
+                    total += best;
                 }
+                if (!accepted) continue;
+                Match match{total, static_cast<int>(shared), bookId};
+                matches.insert(upper_bound(matches.begin(), matches.end(), match, ranksBefore), match);
+                if (matches.size() > limit) matches.pop_back();
             }
         }
+
+        vector<int> result;
+        for (const auto& match : matches) result.push_back(match.bookId);
+        return result;
     }
 };
 
-// User Management
-class User {
+// Radix trie over titles, authors and series names. Every node caches the
+// most borrowed completions below it, so a lookup costs only the prefix
+// length no matter how large the catalog grows.
+class AutocompleteIndex {
 private:
-    string username;
-    string password;
-    string fullName;
-    string email;
-    string joinDate;
-    vector<int> borrowedBooks;
-    vector<string> borrowingDates;
-    vector<string> dueDates;
-    vector<string> favoriteGenres;
-    int totalBooksBorrowed;
-    UserType type;
-    double balance;
-    vector<int> reservedBooks;
-    int loginAttempts;
-    string lastLogin;
-    bool isActive;
-    vector<string> readingHistory;
-    map<string, int> genrePreferences;
-    vector<string> wishlist;
+    struct Entry {
+        string text;
+        long long score;    // total borrows of the books carrying this text
+        int refs;
+    };
 
-public:
-    User(string u, string p, string name, string email, 
-         UserType t = UserType::STANDARD)
-        : username(u), password(p), fullName(name), email(email),
-          joinDate(LibraryUtils::getCurrentDateTime()), totalBooksBorrowed(0),
-          type(t), balance(0.0), loginAttempts(0), isActive(true) {}
+    struct Node {
+        string label;           // edge label from the parent
+        vector<int> children;   // sorted by first label character
+        int entry = -1;
+        vector<int> top;        // best entries in this subtree, best first
+    };
 
-    bool authenticate(string u, string p) {
-        if (!isActive) {
-            cout << "Account is inactive.\n";
-            return false;
-        }
-        if (username == u && password == p) {
-            loginAttempts = 0;
-            lastLogin = LibraryUtils::getCurrentDateTime();
-            return true;
+    struct BookKeys {
+        vector<string> keys;
+        int borrowCount;
+    };
+
+    vector<Node> nodes;
+    vector<Entry> entries;
+    vector<int> freeEntries;
+    unordered_map<string, int> entryByKey;
+    unordered_map<int, BookKeys> keysByBook;
+
+    bool better(int a, int b) const {
+        if (entries[a].score != entries[b].score) return entries[a].score > entries[b].score;
+        return entries[a].text < entries[b].text;
+    }
+
+    int findChild(int node, char c) const {
+        for (int child : nodes[node].children) {
+            if (nodes[child].label[0] == c) return child;
         }
-        loginAttempts++;
-        if (loginAttempts >= MAX_LOGIN_ATTEMPTS) {
-            isActive = false;
-            cout << "Too many failed login attempts. Account locked.\n";
+        return -1;
+    }
+
+    void addChild(int parent, int child) {
+        vector<int>& children = nodes[parent].children;
+        char c = nodes[child].label[0];
+        auto it = children.begin();
+        while (it != children.end() && nodes[*it].label[0] < c) ++it;
+        children.insert(it, child);
+    }
+
+    // Walks (and creates as needed) the node path for key, root first
+    vector<int> insertPath(const string& key) {
+        vector<int> path = {0};
+        size_t pos = 0;
+        int node = 0;
+        while (pos < key.size()) {
+            int child = findChild(node, key[pos]);
+            if (child < 0) {
+                Node leaf;
+                leaf.label = key.substr(pos);
+                nodes.push_back(leaf);
+                int created = static_cast<int>(nodes.size()) - 1;
+                addChild(node, created);
+                path.push_back(created);
+                return path;
+            }
+            const string label = nodes[child].label;
+            size_t common = 0;
+            while (common < label.size() && pos + common < key.size() &&
+                   label[common] == key[pos + common]) {
+                ++common;
+            }
+            if (common < label.size()) {
+                // Split the edge so the key ends on (or branches from) a node
+                Node middle;
+                middle.label = label.substr(0, common);
+                middle.top = nodes[child].top;
+                nodes.push_back(middle);
+                int split = static_cast<int>(nodes.size()) - 1;
+                nodes[child].label = label.substr(common);
+                replace(nodes[node].children.begin(), nodes[node].children.end(), child, split);
+                nodes[split].children.push_back(child);
+                child = split;
+            }
+            path.push_back(child);
+            node = child;
+            pos += common;
         }
-        return false;
+        return path;
     }
 
-    bool canBorrowMore() const {
-        int limit = MAX_BORROW_LIMIT;
-        switch (type) {
-            case UserType::PREMIUM: limit *= 2; break;
-                        case UserType::FACULTY: limit = 10; break;
-            case UserType::STAFF: limit = 8; break;
-            case UserType::GUEST: limit = 2; break;
-            default: break;
+    vector<int> existingPath(const string& key) const {
+        vector<int> path = {0};
+        size_t pos = 0;
+        int node = 0;
+        while (pos < key.size()) {
+            int child = findChild(node, key[pos]);
+            if (child < 0 || key.compare(pos, nodes[child].label.size(), nodes[child].label) != 0) {
+                return {};
+            }
+            path.push_back(child);
+            node = child;
+            pos += nodes[child].label.size();
         }
-        return borrowedBooks.size() < limit;
+        return path;
     }
 
-    int getBorrowLimit() const {
-        switch (type) {
-            case UserType::PREMIUM: return MAX_BORROW_LIMIT * 2;
-            case UserType::FACULTY: return 10;
-            case UserType::STAFF: return 8;
-            case UserType::GUEST: return 2;
-            default: return MAX_BORROW_LIMIT;
+    // Rebuilds the cached top lists bottom-up; a subtree's best entries are
+    // always among its children's best entries plus its own.
+    void refreshPath(const vector<int>& path) {
+        for (size_t i = path.size(); i-- > 0; ) {
+            Node& node = nodes[path[i]];
+            vector<int> candidates;
+            if (node.entry >= 0 && entries[node.entry].refs > 0) candidates.push_back(node.entry);
+            for (int child : node.children) {
+                for (int e : nodes[child].top) candidates.push_back(e);
+            }
+            size_t keep = min(candidates.size(), static_cast<size_t>(AUTOCOMPLETE_TOP_N));
+            partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                         [this](int a, int b) { return better(a, b); });
+            candidates.resize(keep);
+            node.top = move(candidates);
         }
     }
 
-    bool borrowBook(int bookID, const string& dueDate = "") {
-        if (!canBorrowMore()) {
-            cout << "Borrow limit reached (" << getBorrowLimit() << " books). Please return some books first.\n";
-            return false;
+    void adjustKey(const string& text, long long scoreDelta, int refDelta) {
+        string key = LibraryUtils::toLower(LibraryUtils::trim(text));
+        if (key.empty()) return;
+
+        auto found = entryByKey.find(key);
+        int entry;
+        if (found != entryByKey.end()) {
+            entry = found->second;
+        } else {
+            if (refDelta <= 0) return;
+            if (!freeEntries.empty()) {
+                entry = freeEntries.back();
+                freeEntries.pop_back();
+                entries[entry] = {LibraryUtils::trim(text), 0, 0};
+            } else {
+                entries.push_back({LibraryUtils::trim(text), 0, 0});
+                entry = static_cast<int>(entries.size()) - 1;
+            }
+            entryByKey[key] = entry;
         }
-        if (find(borrowedBooks.begin(), borrowedBooks.end(), bookID) != borrowedBooks.end()) {
-            cout << "You've already borrowed this book.\n";
-            return false;
+
+        entries[entry].score += scoreDelta;
+        entries[entry].refs += refDelta;
+
+        vector<int> path = refDelta > 0 ? insertPath(key) : existingPath(key);
+        if (path.empty()) return;
+        nodes[path.back()].entry = entry;
+        if (entries[entry].refs <= 0) {
+            nodes[path.back()].entry = -1;
+            entryByKey.erase(key);
+            freeEntries.push_back(entry);
         }
-        borrowedBooks.push_back(bookID);
-        borrowingDates.push_back(LibraryUtils::getCurrentDateTime());
-        dueDates.push_back(dueDate.empty() ? LibraryUtils::getCurrentDate() : dueDate);
-        totalBooksBorrowed++;
-        readingHistory.push_back("Borrowed book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
-        return true;
+        refreshPath(path);
     }
 
-    bool returnBook(int bookID) {
-        auto it = find(borrowedBooks.begin(), borrowedBooks.end(), bookID);
-        if (it != borrowedBooks.end()) {
-            size_t index = distance(borrowedBooks.begin(), it);
-            borrowedBooks.erase(it);
-            borrowingDates.erase(borrowingDates.begin() + index);
-            dueDates.erase(dueDates.begin() + index);
-            readingHistory.push_back("Returned book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
-            cout << "Book ID " << bookID << " returned successfully.\n";
-            return true;
+    static vector<string> keysFor(const Book* book) {
+        vector<string> keys = {book->getTitle(), book->getAuthor()};
+        if (const FictionBook* fiction = dynamic_cast<const FictionBook*>(book)) {
+            if (!fiction->getSeriesName().empty()) keys.push_back(fiction->getSeriesName());
         }
-        cout << "Book not found in your borrowed list.\n";
-        return false;
+        sort(keys.begin(), keys.end());
+        keys.erase(unique(keys.begin(), keys.end()), keys.end());
+        return keys;
     }
 
-    bool reserveBook(int bookID) {
-        if (find(reservedBooks.begin(), reservedBooks.end(), bookID) != reservedBooks.end()) {
-            cout << "You've already reserved this book.\n";
-            return false;
-        }
-        reservedBooks.push_back(bookID);
-        readingHistory.push_back("Reserved book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
-        cout << "Book ID " << bookID << " reserved successfully.\n";
-        return true;
+public:
+    AutocompleteIndex() : nodes(1) {}
+
+    void add(const Book* book) {
+        BookKeys record = {keysFor(book), book->getBorrowCount()};
+        for (const auto& key : record.keys) adjustKey(key, record.borrowCount, 1);
+        keysByBook[book->getId()] = move(record);
     }
 
-    bool cancelReservation(int bookID) {
-        auto it = find(reservedBooks.begin(), reservedBooks.end(), bookID);
-        if (it != reservedBooks.end()) {
-            reservedBooks.erase(it);
-            readingHistory.push_back("Cancelled reservation for book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
-            cout << "Reservation for book ID " << bookID << " cancelled.\n";
-            return true;
-        }
-        cout << "No reservation found for this book.\n";
-        return false;
+    void remove(int bookId) {
+        auto it = keysByBook.find(bookId);
+        if (it == keysByBook.end()) return;
+        for (const auto& key : it->second.keys) adjustKey(key, -it->second.borrowCount, -1);
+        keysByBook.erase(it);
     }
 
-    void displayBorrowedBooks() const {
-        if (borrowedBooks.empty()) {
-            cout << "No books currently borrowed.\n";
+    void recordBorrow(int bookId) {
+        auto it = keysByBook.find(bookId);
+        if (it == keysByBook.end()) return;
+        it->second.borrowCount++;
+        for (const auto& key : it->second.keys) adjustKey(key, 1, 0);
+    }
+
+    vector<string> complete(const string& prefix, size_t limit) const {
+        string key = LibraryUtils::toLower(prefix);
+        size_t pos = 0;
+        int node = 0;
+        while (pos < key.size()) {
+            int child = findChild(node, key[pos]);
+            if (child < 0) return {};
+            const string& label = nodes[child].label;
+            size_t len = min(label.size(), key.size() - pos);
+            if (key.compare(pos, len, label, 0, len) != 0) return {};
+            node = child;
+            pos += len;
+        }
+
+        vector<string> completions;
+        for (int entry : nodes[node].top) {
+            if (completions.size() >= limit) break;
+            completions.push_back(entries[entry].text);
+        }
+        return completions;
+    }
+};
+
+// Compressed set of book IDs: only the non-zero 64-bit words are stored,
+// keyed by word index, so sparse facets stay small and AND/OR are merges.
+class BookBitmap {
+private:
+    vector<uint32_t> keys;
+    vector<uint64_t> words;
+
+public:
+    void set(int id) {
+        uint32_t key = static_cast<uint32_t>(id) >> 6;
+        uint64_t bit = 1ULL << (id & 63);
+        if (keys.empty() || keys.back() < key) {
+            keys.push_back(key);
+            words.push_back(bit);
             return;
         }
-        cout << "Books currently borrowed by " << username << ":\n";
-        cout << "----------------------------------------\n";
-        for (size_t i = 0; i < borrowedBooks.size(); ++i) {
-            cout << "- Book ID: " << borrowedBooks[i] 
-                 << " (borrowed on " << borrowingDates[i] 
-                 << ", due on " << dueDates[i] << ")\n";
+        auto it = lower_bound(keys.begin(), keys.end(), key);
+        size_t pos = it - keys.begin();
+        if (it != keys.end() && *it == key) {
+            words[pos] |= bit;
+        } else {
+            keys.insert(it, key);
+            words.insert(words.begin() + pos, bit);
         }
-        cout << "----------------------------------------\n";
     }
 
-    void displayReservedBooks() const {
-        if (reservedBooks.empty()) {
-            cout << "No books currently reserved.\n";
-            return;
+    void clear(int id) {
+        uint32_t key = static_cast<uint32_t>(id) >> 6;
+        auto it = lower_bound(keys.begin(), keys.end(), key);
+        if (it == keys.end() || *it != key) return;
+        size_t pos = it - keys.begin();
+        words[pos] &= ~(1ULL << (id & 63));
+        if (words[pos] == 0) {
+            keys.erase(it);
+            words.erase(words.begin() + pos);
         }
-        cout << "Books currently reserved by " << username << ":\n";
-        cout << "----------------------------------------\n";
-        for (const auto& bookID : reservedBooks) {
-            cout << "- Book ID: " << bookID << "\n";
+    }
+
+    bool test(int id) const {
+        uint32_t key = static_cast<uint32_t>(id) >> 6;
+        auto it = lower_bound(keys.begin(), keys.end(), key);
+        return it != keys.end() && *it == key &&
+               (words[it - keys.begin()] >> (id & 63)) & 1;
+    }
+
+    bool empty() const { return keys.empty(); }
+
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t w : words) total += bitset<64>(w).count();
+        return total;
+    }
+
+    BookBitmap operator&(const BookBitmap& other) const {
+        BookBitmap result;
+        size_t i = 0, j = 0;
+        while (i < keys.size() && j < other.keys.size()) {
+            if (keys[i] < other.keys[j]) ++i;
+            else if (other.keys[j] < keys[i]) ++j;
+            else {
+                uint64_t w = words[i] & other.words[j];
+                if (w) {
+                    result.keys.push_back(keys[i]);
+                    result.words.push_back(w);
+                }
+                ++i; ++j;
+            }
         }
-        cout << "----------------------------------------\n";
+        return result;
     }
 
-    void addFavoriteGenre(const string& genre) {
-        string lowerGenre = LibraryUtils::toLower(genre);
-        if (find(favoriteGenres.begin(), favoriteGenres.end(), lowerGenre) == favoriteGenres.end()) {
-            favoriteGenres.push_back(lowerGenre);
-            genrePreferences[lowerGenre]++;
-            cout << "Added " << genre << " to favorite genres.\n";
+    BookBitmap operator|(const BookBitmap& other) const {
+        BookBitmap result;
+        size_t i = 0, j = 0;
+        while (i < keys.size() || j < other.keys.size()) {
+            if (j == other.keys.size() || (i < keys.size() && keys[i] < other.keys[j])) {
+                result.keys.push_back(keys[i]);
+                result.words.push_back(words[i++]);
+            } else if (i == keys.size() || other.keys[j] < keys[i]) {
+                result.keys.push_back(other.keys[j]);
+                result.words.push_back(other.words[j++]);
+            } else {
+                result.keys.push_back(keys[i]);
+                result.words.push_back(words[i++] | other.words[j++]);
+            }
         }
+        return result;
     }
 
-    void addToWishlist(const string& bookTitle) {
-        if (find(wishlist.begin(), wishlist.end(), bookTitle) == wishlist.end()) {
-            wishlist.push_back(bookTitle);
-            cout << "Added \"" << bookTitle << "\" to your wishlist.\n";
+    // Size of the intersection without building it
+    size_t andCount(const BookBitmap& other) const {
+        size_t total = 0, i = 0, j = 0;
+        while (i < keys.size() && j < other.keys.size()) {
+            if (keys[i] < other.keys[j]) ++i;
+            else if (other.keys[j] < keys[i]) ++j;
+            else total += bitset<64>(words[i++] & other.words[j++]).count();
         }
+        return total;
     }
 
-    void displayProfile() const {
-        cout << "\nUser Profile for " << username << ":\n";
-        cout << "----------------------------------------\n";
-        cout << "Full Name: " << fullName << "\n";
-        cout << "Email: " << email << "\n";
-        cout << "Member Since: " << joinDate << "\n";
-        cout << "Last Login: " << (lastLogin.empty() ? "Never" : lastLogin) << "\n";
-        cout << "Account Type: ";
-        switch (type) {
+    vector<int> toIds() const {
+        vector<int> ids;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            uint64_t w = words[i];
+            while (w) {
+                int bit = static_cast<int>(bitset<64>((w & (~w + 1)) - 1).count());
+                ids.push_back(static_cast<int>(keys[i] << 6) + bit);
+                w &= w - 1;
+            }
+        }
+        return ids;
+    }
+};
+
+// Combined filter: values within a field are OR-ed, fields are AND-ed.
+// Empty fields and a zero year bound mean "any".
+struct FacetQuery {
+    vector<BookStatus> statuses;
+    vector<BookFormat> formats;
+    vector<string> genres;
+    vector<string> languages;
+    vector<string> locations;
+    int minYear = 0;
+    int maxYear = 0;
+};
+
+// Genre, language and location counts are keyed by their lowercased value
+struct FacetResult {
+    vector<Book*> books;
+    map<BookStatus, int> statusCounts;
+    map<BookFormat, int> formatCounts;
+    map<string, int> genreCounts;
+    map<string, int> languageCounts;
+    map<string, int> locationCounts;
+    map<int, int> yearCounts;
+};
+
+class FacetIndex {
+private:
+    struct DocFacets {
+        BookStatus status;
+        BookFormat format;
+        Symbol genre;
+        Symbol language;
+        Symbol location;
+        int year;
+        vector<Symbol> tags;
+    };
+
+    BookBitmap all;
+    map<BookStatus, BookBitmap> byStatus;
+    map<BookFormat, BookBitmap> byFormat;
+    map<Symbol, BookBitmap> byGenre;       // keys are lowercased symbols
+    map<Symbol, BookBitmap> byLanguage;
+    map<Symbol, BookBitmap> byLocation;
+    map<Symbol, BookBitmap> byTag;
+    map<int, BookBitmap> byYear;
+    unordered_map<int, DocFacets> docs;
+
+    template <typename K>
+    static void unset(map<K, BookBitmap>& facet, const K& key, int id) {
+        auto it = facet.find(key);
+        if (it == facet.end()) return;
+        it->second.clear(id);
+        if (it->second.empty()) facet.erase(it);
+    }
+
+    static Symbol fold(const string& value) {
+        return StringPool::folded(StringPool::intern(value));
+    }
+
+    static BookBitmap anyOf(const map<Symbol, BookBitmap>& facet, const vector<string>& values) {
+        BookBitmap result;
+        for (const auto& value : values) {
+            Symbol key;
+            if (!StringPool::find(LibraryUtils::toLower(value), key)) continue;
+            auto it = facet.find(key);
+            if (it != facet.end()) result = result | it->second;
+        }
+        return result;
+    }
+
+    template <typename K>
+    static BookBitmap anyOf(const map<K, BookBitmap>& facet, const vector<K>& values) {
+        BookBitmap result;
+        for (const auto& value : values) {
+            auto it = facet.find(value);
+            if (it != facet.end()) result = result | it->second;
+        }
+        return result;
+    }
+
+    template <typename K, typename V>
+    static void countInto(const map<K, BookBitmap>& facet, const BookBitmap& hits, map<V, int>& counts) {
+        for (const auto& pair : facet) {
+            size_t n = pair.second.andCount(hits);
+            if (n > 0) counts[pair.first] = static_cast<int>(n);
+        }
+    }
+
+    static void countInto(const map<Symbol, BookBitmap>& facet, const BookBitmap& hits,
+                          map<string, int>& counts) {
+        for (const auto& pair : facet) {
+            size_t n = pair.second.andCount(hits);
+            if (n > 0) counts[StringPool::text(pair.first)] = static_cast<int>(n);
+        }
+    }
+
+public:
+    void add(const Book* book) {
+        int id = book->getId();
+        DocFacets doc = {book->getStatus(), book->getFormat(), fold(book->getGenre()),
+                         fold(book->getLanguage()), fold(book->getLocation()), book->getYear(), {}};
+        for (Symbol tag : book->getTags()) doc.tags.push_back(StringPool::folded(tag));
+
+        all.set(id);
+        byStatus[doc.status].set(id);
+        byFormat[doc.format].set(id);
+        byGenre[doc.genre].set(id);
+        byLanguage[doc.language].set(id);
+        byLocation[doc.location].set(id);
+        byYear[doc.year].set(id);
+        for (Symbol tag : doc.tags) byTag[tag].set(id);
+        docs[id] = move(doc);
+    }
+
+    void remove(int bookId) {
+        auto it = docs.find(bookId);
+        if (it == docs.end()) return;
+        const DocFacets& doc = it->second;
+        all.clear(bookId);
+        unset(byStatus, doc.status, bookId);
+        unset(byFormat, doc.format, bookId);
+        unset(byGenre, doc.genre, bookId);
+        unset(byLanguage, doc.language, bookId);
+        unset(byLocation, doc.location, bookId);
+        unset(byYear, doc.year, bookId);
+        for (Symbol tag : doc.tags) unset(byTag, tag, bookId);
+        docs.erase(it);
+    }
+
+    void updateStatus(int bookId, BookStatus status) {
+        auto it = docs.find(bookId);
+        if (it == docs.end() || it->second.status == status) return;
+        unset(byStatus, it->second.status, bookId);
+        byStatus[status].set(bookId);
+        it->second.status = status;
+    }
+
+    BookBitmap filter(const FacetQuery& query) const {
+        BookBitmap result = all;
+        if (!query.statuses.empty()) result = result & anyOf(byStatus, query.statuses);
+        if (!query.formats.empty()) result = result & anyOf(byFormat, query.formats);
+        if (!query.genres.empty()) result = result & anyOf(byGenre, query.genres);
+        if (!query.languages.empty()) result = result & anyOf(byLanguage, query.languages);
+        if (!query.locations.empty()) result = result & anyOf(byLocation, query.locations);
+        if (query.minYear != 0 || query.maxYear != 0) {
+            BookBitmap years;
+            auto it = query.minYear != 0 ? byYear.lower_bound(query.minYear) : byYear.begin();
+            for (; it != byYear.end() && (query.maxYear == 0 || it->first <= query.maxYear); ++it) {
+                years = years | it->second;
+            }
+            result = result & years;
+        }
+        return result;
+    }
+
+    // Books whose genre or one of whose tags equals the given name
+    BookBitmap genreOrTag(const string& name) const {
+        Symbol key;
+        BookBitmap result;
+        if (!StringPool::find(LibraryUtils::toLower(name), key)) return result;
+        auto genre = byGenre.find(key);
+        if (genre != byGenre.end()) result = genre->second;
+        auto tag = byTag.find(key);
+        if (tag != byTag.end()) result = result | tag->second;
+        return result;
+    }
+
+    void countFacets(const BookBitmap& hits, FacetResult& result) const {
+        countInto(byStatus, hits, result.statusCounts);
+        countInto(byFormat, hits, result.formatCounts);
+        countInto(byGenre, hits, result.genreCounts);
+        countInto(byLanguage, hits, result.languageCounts);
+        countInto(byLocation, hits, result.locationCounts);
+        countInto(byYear, hits, result.yearCounts);
+    }
+};
+
+// Author, series and course lookups. Multi-author textbooks are listed
+// under each of their authors; series come back in reading order.
+class BibliographicIndex {
+private:
+    struct DocKeys {
+        vector<string> authors;
+        string series;
+        int seriesNumber;
+        string course;
+    };
+
+    unordered_map<string, vector<int>> byAuthor;          // sorted book IDs
+    unordered_map<string, set<pair<int, int>>> bySeries;  // (series number, book ID)
+    unordered_map<string, vector<int>> byCourse;          // sorted book IDs
+    unordered_map<int, DocKeys> docs;
+
+    static string key(const string& value) {
+        return LibraryUtils::toLower(LibraryUtils::trim(value));
+    }
+
+    static void insertId(vector<int>& ids, int id) {
+        auto it = lower_bound(ids.begin(), ids.end(), id);
+        if (it == ids.end() || *it != id) ids.insert(it, id);
+    }
+
+    static void eraseId(unordered_map<string, vector<int>>& index, const string& k, int id) {
+        auto it = index.find(k);
+        if (it == index.end()) return;
+        auto pos = lower_bound(it->second.begin(), it->second.end(), id);
+        if (pos != it->second.end() && *pos == id) it->second.erase(pos);
+        if (it->second.empty()) index.erase(it);
+    }
+
+    static const vector<int>& lookup(const unordered_map<string, vector<int>>& index, const string& k) {
+        static const vector<int> none;
+        auto it = index.find(k);
+        return it != index.end() ? it->second : none;
+    }
+
+public:
+    void add(const Book* book) {
+        DocKeys doc = {{}, "", 0, ""};
+        if (const ScienceTextbook* textbook = dynamic_cast<const ScienceTextbook*>(book)) {
+            for (const auto& author : textbook->getAuthors()) doc.authors.push_back(key(author));
+            doc.course = key(textbook->getCourseCode());
+        } else {
+            doc.authors.push_back(key(book->getAuthor()));
+        }
+        if (const FictionBook* fiction = dynamic_cast<const FictionBook*>(book)) {
+            if (fiction->getIsSeries() && !fiction->getSeriesName().empty()) {
+                doc.series = key(fiction->getSeriesName());
+                doc.seriesNumber = fiction->getSeriesNumber();
+            }
+        }
+
+        int id = book->getId();
+        for (const auto& author : doc.authors) {
+            if (!author.empty()) insertId(byAuthor[author], id);
+        }
+        if (!doc.series.empty()) bySeries[doc.series].insert({doc.seriesNumber, id});
+        if (!doc.course.empty()) insertId(byCourse[doc.course], id);
+        docs[id] = move(doc);
+    }
+
+    void remove(int bookId) {
+        auto it = docs.find(bookId);
+        if (it == docs.end()) return;
+        const DocKeys& doc = it->second;
+        for (const auto& author : doc.authors) eraseId(byAuthor, author, bookId);
+        if (!doc.series.empty()) {
+            auto series = bySeries.find(doc.series);
+            if (series != bySeries.end()) {
+                series->second.erase({doc.seriesNumber, bookId});
+                if (series->second.empty()) bySeries.erase(series);
+            }
+        }
+        if (!doc.course.empty()) eraseId(byCourse, doc.course, bookId);
+        docs.erase(it);
+    }
+
+    const vector<int>& byAuthorName(const string& author) const {
+        return lookup(byAuthor, key(author));
+    }
+
+    vector<int> inSeries(const string& series) const {
+        vector<int> ids;
+        auto it = bySeries.find(key(series));
+        if (it == bySeries.end()) return ids;
+        for (const auto& entry : it->second) ids.push_back(entry.second);
+        return ids;
+    }
+
+    const vector<int>& forCourse(const string& courseCode) const {
+        return lookup(byCourse, key(courseCode));
+    }
+};
+
+// Struct-of-arrays copy of the per-book values the analytics reports
+// scan, so a full-catalog pass walks contiguous arrays instead of Book
+// objects. Book type and genre are stored as codes into small per-column
+// dictionaries of interned names.
+class CatalogColumns {
+private:
+    // Distinct values seen in one column; a count is sized by these, never
+    // by the whole StringPool
+    struct Dictionary {
+        vector<Symbol> labels;                    // code -> display name
+        unordered_map<Symbol, uint32_t> codes;    // interned key -> code
+
+        uint32_t code(Symbol key, Symbol label) {
+            auto it = codes.find(key);
+            if (it != codes.end()) return it->second;
+            codes.emplace(key, static_cast<uint32_t>(labels.size()));
+            labels.push_back(label);
+            return static_cast<uint32_t>(labels.size() - 1);
+        }
+    };
+
+    vector<int> ids;
+    vector<BookStatus> statuses;
+    vector<BookFormat> formats;
+    vector<int> years;
+    vector<int> borrowCounts;
+    vector<double> ratingSums;
+    vector<int> ratingCounts;
+    vector<uint32_t> typeCodes;
+    vector<uint32_t> genreCodes;       // genres differing only in case share a code
+    Dictionary types;
+    Dictionary genres;
+    unordered_map<int, size_t> rowById;
+
+    static map<string, int> countCodes(const vector<uint32_t>& codes, const Dictionary& dictionary) {
+        vector<int> counts(dictionary.labels.size());
+        for (uint32_t code : codes) counts[code]++;
+        map<string, int> result;
+        for (size_t code = 0; code < counts.size(); ++code) {
+            if (counts[code] > 0) result[StringPool::text(dictionary.labels[code])] += counts[code];
+        }
+        return result;
+    }
+
+public:
+    void add(const Book* book) {
+        rowById[book->getId()] = ids.size();
+        ids.push_back(book->getId());
+        statuses.push_back(book->getStatus());
+        formats.push_back(book->getFormat());
+        years.push_back(book->getYear());
+        borrowCounts.push_back(book->getBorrowCount());
+        ratingSums.push_back(book->getRatingTotal());
+        ratingCounts.push_back(book->getRatingCount());
+        Symbol type = StringPool::intern(book->getBookType());
+        Symbol genre = StringPool::intern(book->getGenre());
+        typeCodes.push_back(types.code(type, type));
+        genreCodes.push_back(genres.code(StringPool::folded(genre), genre));
+    }
+
+    // Moves the last row into the removed row's slot
+    void remove(int bookId) {
+        auto it = rowById.find(bookId);
+        if (it == rowById.end()) return;
+        size_t row = it->second;
+        size_t last = ids.size() - 1;
+        if (row != last) {
+            ids[row] = ids[last];
+            statuses[row] = statuses[last];
+            formats[row] = formats[last];
+            years[row] = years[last];
+            borrowCounts[row] = borrowCounts[last];
+            ratingSums[row] = ratingSums[last];
+            ratingCounts[row] = ratingCounts[last];
+            typeCodes[row] = typeCodes[last];
+            genreCodes[row] = genreCodes[last];
+            rowById[ids[row]] = row;
+        }
+        ids.pop_back();
+        statuses.pop_back();
+        formats.pop_back();
+        years.pop_back();
+        borrowCounts.pop_back();
+        ratingSums.pop_back();
+        ratingCounts.pop_back();
+        typeCodes.pop_back();
+        genreCodes.pop_back();
+        rowById.erase(it);
+    }
+
+    // Copies the mutable fields (status, borrows, ratings) from the book
+    void update(const Book* book) {
+        auto it = rowById.find(book->getId());
+        if (it == rowById.end()) return;
+        size_t row = it->second;
+        statuses[row] = book->getStatus();
+        borrowCounts[row] = book->getBorrowCount();
+        ratingSums[row] = book->getRatingTotal();
+        ratingCounts[row] = book->getRatingCount();
+    }
+
+    size_t size() const { return ids.size(); }
+
+    long long totalBorrows() const {
+        long long total = 0;
+        for (int count : borrowCounts) total += count;
+        return total;
+    }
+
+    // Catalog-wide counts for the stats report
+    map<string, int> typeCounts() const { return countCodes(typeCodes, types); }
+
+    map<string, int> genreCounts() const { return countCodes(genreCodes, genres); }
+
+    map<BookStatus, int> statusCounts() const {
+        int counts[static_cast<int>(BookStatus::UNDER_MAINTENANCE) + 1] = {};
+        for (BookStatus status : statuses) counts[static_cast<int>(status)]++;
+        map<BookStatus, int> result;
+        for (int status = 0; status <= static_cast<int>(BookStatus::UNDER_MAINTENANCE); ++status) {
+            if (counts[status] > 0) result[static_cast<BookStatus>(status)] = counts[status];
+        }
+        return result;
+    }
+
+    // (book ID, borrow count) of the k most borrowed books, most borrowed first
+    vector<pair<int, int>> mostBorrowed(size_t k) const {
+        vector<size_t> rows(ids.size());
+        for (size_t row = 0; row < rows.size(); ++row) rows[row] = row;
+        size_t keep = min(k, rows.size());
+        partial_sort(rows.begin(), rows.begin() + keep, rows.end(), [this](size_t a, size_t b) {
+            return borrowCounts[a] != borrowCounts[b] ? borrowCounts[a] > borrowCounts[b]
+                                                      : ids[a] < ids[b];
+        });
+        vector<pair<int, int>> top;
+        for (size_t i = 0; i < keep; ++i) {
+            top.push_back({ids[rows[i]], borrowCounts[rows[i]]});
+        }
+        return top;
+    }
+};
+
+class CatalogIndex {
+private:
+    // Indexes built on first use rather than on load, so opening a large
+    // snapshot only pays for byId and the columns
+    enum LazyIndex : unsigned {
+        ISBN = 1,
+        TEXT = 2,
+        FUZZY = 4,
+        SUGGESTIONS = 8,
+        FACETS = 16,
+        BIBLIOGRAPHIC = 32
+    };
+
+    unordered_map<int, Book*> byId;
+    CatalogColumns columns;
+    mutable unsigned built = 0;     // LazyIndex bits
+    mutable unordered_map<uint64_t, Book*> byIsbn;
+    mutable InvertedIndex text;
+    mutable TrigramIndex fuzzy;
+    mutable AutocompleteIndex suggestions;
+    mutable FacetIndex facets;
+    mutable BibliographicIndex bibliographic;
+
+    void addTo(unsigned indexes, Book* book) const {
+        if (indexes & ISBN) {
+            uint64_t isbnKey;
+            if (LibraryUtils::normalizeISBN(book->getISBN(), isbnKey)) {
+                byIsbn[isbnKey] = book;
+            }
+        }
+        if (indexes & TEXT) text.add(book);
+        if (indexes & FUZZY) fuzzy.add(book);
+        if (indexes & SUGGESTIONS) suggestions.add(book);
+        if (indexes & FACETS) facets.add(book);
+        if (indexes & BIBLIOGRAPHIC) bibliographic.add(book);
+    }
+
+    void removeFrom(unsigned indexes, const Book* book) const {
+        int bookId = book->getId();
+        if (indexes & ISBN) {
+            uint64_t isbnKey;
+            if (LibraryUtils::normalizeISBN(book->getISBN(), isbnKey)) {
+                byIsbn.erase(isbnKey);
+            }
+        }
+        if (indexes & TEXT) text.remove(bookId);
+        if (indexes & FUZZY) fuzzy.remove(bookId);
+        if (indexes & SUGGESTIONS) suggestions.remove(bookId);
+        if (indexes & FACETS) facets.remove(bookId);
+        if (indexes & BIBLIOGRAPHIC) bibliographic.remove(bookId);
+    }
+
+    // Builds an index from every cataloged book, in ID order as the
+    // posting lists expect
+    void ensure(LazyIndex index) const {
+        if (built & index) return;
+        vector<Book*> ordered;
+        ordered.reserve(byId.size());
+        for (const auto& entry : byId) ordered.push_back(entry.second);
+        sort(ordered.begin(), ordered.end(),
+             [](const Book* a, const Book* b) { return a->getId() < b->getId(); });
+        if (index == ISBN) byIsbn.reserve(ordered.size());
+        for (Book* book : ordered) addTo(index, book);
+        built |= index;
+    }
+
+public:
+    void add(Book* book) {
+        byId[book->getId()] = book;
+        columns.add(book);
+        addTo(built, book);
+    }
+
+    void remove(int bookId) {
+        auto it = byId.find(bookId);
+        if (it == byId.end()) return;
+        removeFrom(built, it->second);
+        columns.remove(bookId);
+        byId.erase(it);
+    }
+
+    // Call after changing a book's title, description or tags
+    void reindex(Book* book) {
+        unsigned indexes = built & ~ISBN;
+        removeFrom(indexes, book);
+        addTo(indexes, book);
+    }
+
+    // Call after a book's status, borrow count or ratings change
+    void refresh(const Book* book) {
+        if (built & FACETS) facets.updateStatus(book->getId(), book->getStatus());
+        columns.update(book);
+    }
+
+    void recordBorrow(const Book* book) {
+        if (built & SUGGESTIONS) suggestions.recordBorrow(book->getId());
+    }
+
+    Book* findById(int bookId) const {
+        auto it = byId.find(bookId);
+        return it != byId.end() ? it->second : nullptr;
+    }
+
+    vector<Book*> resolve(const vector<int>& ids) const {
+        vector<Book*> results;
+        results.reserve(ids.size());
+        for (int id : ids) {
+            results.push_back(findById(id));
+        }
+        return results;
+    }
+
+    vector<Book*> search(const string& query) const {
+        ensure(TEXT);
+        return resolve(text.search(query));
+    }
+
+    Book* findByISBN(const string& isbn) const {
+        uint64_t isbnKey;
+        if (!LibraryUtils::normalizeISBN(isbn, isbnKey)) return nullptr;
+        ensure(ISBN);
+        auto it = byIsbn.find(isbnKey);
+        return it != byIsbn.end() ? it->second : nullptr;
+    }
+
+    // Explains why a book cannot be cataloged, or returns an empty string
+    string checkISBN(const Book* book) const {
+        uint64_t isbnKey;
+        if (!LibraryUtils::normalizeISBN(book->getISBN(), isbnKey)) {
+            return "Invalid ISBN (bad check digit): " + book->getISBN();
+        }
+        ensure(ISBN);
+        if (byIsbn.count(isbnKey)) {
+            return "A book with ISBN " + book->getISBN() + " is already in the catalog.";
+        }
+        return "";
+    }
+
+    vector<string> autocomplete(const string& prefix, size_t limit) const {
+        ensure(SUGGESTIONS);
+        return suggestions.complete(prefix, limit);
+    }
+
+    vector<Book*> searchFuzzy(const string& query, size_t limit) const {
+        ensure(FUZZY);
+        return resolve(fuzzy.search(query, limit));
+    }
+
+    vector<Book*> searchRanked(const string& query, size_t topK) const {
+        ensure(TEXT);
+        vector<Book*> results;
+        for (const auto& hit : text.rank(query, topK)) {
+            results.push_back(findById(hit.first));
+        }
+        return results;
+    }
+
+    FacetResult filter(const FacetQuery& query) const {
+        ensure(FACETS);
+        FacetResult result;
+        BookBitmap hits = facets.filter(query);
+        result.books = resolve(hits.toIds());
+        facets.countFacets(hits, result);
+        return result;
+    }
+
+    vector<Book*> findByGenre(const string& genre) const {
+        ensure(FACETS);
+        return resolve(facets.genreOrTag(genre).toIds());
+    }
+
+    vector<Book*> findByAuthor(const string& author) const {
+        ensure(BIBLIOGRAPHIC);
+        return resolve(bibliographic.byAuthorName(author));
+    }
+
+    vector<Book*> findSeries(const string& series) const {
+        ensure(BIBLIOGRAPHIC);
+        return resolve(bibliographic.inSeries(series));
+    }
+
+    vector<Book*> findByCourse(const string& courseCode) const {
+        ensure(BIBLIOGRAPHIC);
+        return resolve(bibliographic.forCourse(courseCode));
+    }
+
+    const CatalogColumns& getColumns() const { return columns; }
+
+    size_t size() const { return byId.size(); }
+};
+
+// Transaction class: a fixed-size, trivially copyable record so the log
+// is one dense array. The user is stored by id; Library maps ids to names.
+class Transaction {
+private:
+    time_t transactionTime;   // seconds since the epoch
+    time_t returnTime;        // 0 until returned
+    int transactionId;
+    int userId;
+    int bookId;
+    int dueDay;               // days since 1970-01-01
+    TransactionType transactionType;
+    uint8_t renewals;         // times a borrow has been renewed
+
+public:
+    // A borrow without an explicit due day is due MAX_BORROW_DAYS from today
+    Transaction(int id, int user, int book, TransactionType type, 
+                time_t time = 0, int due = 0)
+        : transactionTime(time), returnTime(0), transactionId(id), userId(user),
+          bookId(book), dueDay(0), transactionType(type), renewals(0) {
+        if (transactionTime == 0) transactionTime = LibraryUtils::now();
+        
+        if (type == TransactionType::BORROW) {
+            dueDay = due != 0 ? due : LibraryUtils::currentDay() + MAX_BORROW_DAYS;
+        }
+    }
+
+    static const char* typeName(TransactionType type) {
+        switch (type) {
+            case TransactionType::BORROW: return "borrow";
+            case TransactionType::RETURN: return "return";
+            case TransactionType::RENEW: return "renew";
+            case TransactionType::RESERVE: return "reserve";
+        }
+        return "unknown";
+    }
+
+    // Late fee of a returned borrow, or the fee accrued so far for an open one
+    double calculateLateFee() const {
+        if (transactionType != TransactionType::BORROW) return 0.0;
+        
+        int endDay = returnTime != 0 ? LibraryUtils::dayOf(returnTime) : LibraryUtils::currentDay();
+        int daysLate = endDay - dueDay;
+        return daysLate > 0 ? daysLate * LATE_FEE_PER_DAY : 0.0;
+    }
+
+    void markReturned(time_t time = 0) {
+        returnTime = time != 0 ? time : LibraryUtils::now();
+    }
+
+    void displayInfo(const string& username) const {
+        cout << "Transaction #" << transactionId << " (" << typeName(transactionType) << ")\n";
+        cout << "----------------------------------------\n";
+        cout << "User: " << username << "\n";
+        cout << "Book ID: " << bookId << "\n";
+        cout << "Date: " << LibraryUtils::formatTimestamp(transactionTime) << "\n";
+        if (transactionType == TransactionType::BORROW) {
+            cout << "Due Date: " << LibraryUtils::formatDay(dueDay) << "\n";
+            cout << "Returned: " << (getIsReturned() ? "Yes" : "No") << "\n";
+            if (getIsReturned()) {
+                cout << "Return Date: " << LibraryUtils::formatTimestamp(returnTime) << "\n";
+                if (getLateFee() > 0) {
+                    cout << "Late Fee: $" << fixed << setprecision(2) << getLateFee() << "\n";
+                }
+            }
+        }
+        cout << "----------------------------------------\n";
+    }
+
+    int getId() const { return transactionId; }
+    int getUserId() const { return userId; }
+    int getBookId() const { return bookId; }
+    TransactionType getType() const { return transactionType; }
+    string getDueDate() const { return LibraryUtils::formatDay(dueDay); }
+    int getDueDay() const { return dueDay; }
+    int getRenewals() const { return renewals; }
+    void clearRenewals() { renewals = 0; }
+    time_t getTransactionTime() const { return transactionTime; }
+    time_t getReturnTime() const { return returnTime; }
+    double getLateFee() const { return getIsReturned() ? calculateLateFee() : 0.0; }
+    bool getIsReturned() const { return returnTime != 0; }
+
+    void renew(int additionalDays) {
+        if (transactionType != TransactionType::BORROW || getIsReturned()) return;
+        
+        dueDay += additionalDays;
+        renewals++;
+        cout << "Transaction #" << transactionId << " renewed. New due date: " 
+             << LibraryUtils::formatDay(dueDay) << "\n";
+    }
+};
+
+static_assert(is_trivially_copyable<Transaction>::value, "Transaction must stay a plain record");
+static_assert(sizeof(Transaction) <= 40, "Transaction record grew past 40 bytes");
+
+// Key of an open loan: user id in the high half, book id in the low half
+typedef uint64_t LoanKey;
+
+inline LoanKey makeLoanKey(int userId, int bookId) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(userId)) << 32) | static_cast<uint32_t>(bookId);
+}
+
+// Append-only transaction log made of fixed-size segments. A segment's
+// storage is reserved up front, so appends never move old records. Each
+// segment keeps a summary (time range, open loans, books touched) that
+// lets queries skip whole segments.
+class TransactionLog {
+private:
+    struct Segment {
+        vector<Transaction> records;
+        time_t minTime = numeric_limits<time_t>::max();   // earliest transaction
+        time_t maxTime = numeric_limits<time_t>::min();   // latest transaction
+        size_t openLoans = 0;     // borrows not yet returned
+        BookBitmap books;         // every book id in the segment
+
+        // Whether any record can fall within [from, to)
+        bool overlaps(time_t from, time_t to) const {
+            return !records.empty() && minTime < to && maxTime >= from;
+        }
+    };
+
+    vector<unique_ptr<Segment>> segments;
+    size_t count = 0;
+
+    Transaction& at(size_t index) {
+        return segments[index / TRANSACTION_SEGMENT_SIZE]->records[index % TRANSACTION_SEGMENT_SIZE];
+    }
+
+public:
+    // Returns the position of the new record in the log
+    size_t append(const Transaction& trans) {
+        if (count % TRANSACTION_SEGMENT_SIZE == 0) {
+            segments.push_back(make_unique<Segment>());
+            segments.back()->records.reserve(TRANSACTION_SEGMENT_SIZE);
+        }
+        Segment& seg = *segments.back();
+        seg.records.push_back(trans);
+        seg.minTime = min(seg.minTime, trans.getTransactionTime());
+        seg.maxTime = max(seg.maxTime, trans.getTransactionTime());
+        seg.books.set(trans.getBookId());
+        if (trans.getType() == TransactionType::BORROW && !trans.getIsReturned()) {
+            seg.openLoans++;
+        }
+        return count++;
+    }
+
+    void markReturned(size_t index, time_t time = 0) {
+        Transaction& trans = at(index);
+        if (trans.getIsReturned()) return;
+        trans.markReturned(time);
+        if (trans.getType() == TransactionType::BORROW) {
+            segments[index / TRANSACTION_SEGMENT_SIZE]->openLoans--;
+        }
+    }
+
+    void renew(size_t index, int additionalDays) {
+        at(index).renew(additionalDays);
+    }
+
+    const Transaction& operator[](size_t index) const {
+        return segments[index / TRANSACTION_SEGMENT_SIZE]->records[index % TRANSACTION_SEGMENT_SIZE];
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t segmentCount() const { return segments.size(); }
+
+    // Records are plain bytes, so each segment is written as one block
+    void save(BinaryWriter& out) const {
+        out.write(static_cast<uint32_t>(count));
+        for (const auto& seg : segments) {
+            out.writeBytes(seg->records.data(), seg->records.size() * sizeof(Transaction));
+        }
+    }
+
+    // Appends the saved records, rebuilding the segment summaries. Version 2
+    // snapshots left the renewal count's byte as padding, so it is reset.
+    void load(BinaryReader& in, uint32_t version) {
+        uint32_t total = in.readCount(sizeof(Transaction));
+        Transaction trans(0, 0, 0, TransactionType::RESERVE, 1);
+        for (uint32_t i = 0; i < total && in.ok(); ++i) {
+            in.read(trans);
+            if (version < 3) trans.clearRenewals();
+            append(trans);
+        }
+    }
+
+    // Unreturned borrows and their positions, oldest first; segments
+    // without open loans are skipped
+    template <typename Fn>
+    void forEachOpenLoan(Fn fn) const {
+        for (size_t s = 0; s < segments.size(); ++s) {
+            const Segment& seg = *segments[s];
+            if (seg.openLoans == 0) continue;
+            for (size_t i = 0; i < seg.records.size(); ++i) {
+                const Transaction& trans = seg.records[i];
+                if (trans.getType() == TransactionType::BORROW && !trans.getIsReturned()) {
+                    fn(s * TRANSACTION_SEGMENT_SIZE + i, trans);
+                }
+            }
+        }
+    }
+
+    // Records of one book, oldest first
+    template <typename Fn>
+    void forEachForBook(int bookId, Fn fn) const {
+        for (const auto& seg : segments) {
+            if (!seg->books.test(bookId)) continue;
+            for (const auto& trans : seg->records) {
+                if (trans.getBookId() == bookId) fn(trans);
+            }
+        }
+    }
+
+    // Records dated within the local days [fromDay, toDay], oldest first.
+    // The days are converted to timestamps once, so records are compared
+    // as plain integers.
+    template <typename Fn>
+    void forEachInRange(int fromDay, int toDay, Fn fn) const {
+        time_t from = LibraryUtils::startOfDay(fromDay);
+        time_t to = LibraryUtils::startOfDay(toDay + 1);
+        for (const auto& seg : segments) {
+            if (!seg->overlaps(from, to)) continue;
+            if (seg->minTime >= from && seg->maxTime < to) {
+                for (const auto& trans : seg->records) fn(trans);
+                continue;
+            }
+            for (const auto& trans : seg->records) {
+                time_t time = trans.getTransactionTime();
+                if (time >= from && time < to) fn(trans);
+            }
+        }
+    }
+};
+
+// A notification on its way to delivery
+struct OutgoingNotification {
+    string recipient;
+    string message;
+    NotificationType type;
+    time_t sentTime;
+};
+
+// How long notifications are kept. A zero age or cap disables that rule.
+struct NotificationRetention {
+    int maxAgeDays = NOTIFICATION_MAX_AGE_DAYS;           // any notification
+    int readMaxAgeDays = NOTIFICATION_READ_MAX_AGE_DAYS;  // once it has been read
+    size_t maxPerUser = MAX_NOTIFICATIONS_PER_USER;       // oldest are dropped first
+};
+
+// Approximate heap footprint of the notification store, for operators
+struct NotificationStats {
+    size_t liveNotifications = 0;
+    size_t storeSlots = 0;       // live + removed slots awaiting compaction
+    size_t recipients = 0;
+    size_t approxBytes = 0;
+    size_t highWaterBytes = 0;
+    size_t totalRemoved = 0;
+    size_t compactions = 0;
+};
+
+// Notification System
+// Notifications are stored once; each recipient has an inbox of slots
+// into that store plus an unread counter, and ids map straight to slots.
+// Removed notifications leave dead slots until maintain() packs the
+// store (the dispatcher calls it from its worker thread whenever its
+// queue drains); ids never change. All public methods are thread-safe.
+class NotificationSystem {
+private:
+    struct Notification {
+        int id;
+        string recipient;
+        string message;
+        time_t sentTime;
+        NotificationType type;
+        bool isRead;
+        bool removed;
+    };
+
+    struct Inbox {
+        deque<size_t> slots;    // oldest first
+        size_t unread = 0;
+    };
+
+    vector<Notification> notifications;
+    unordered_map<int, size_t> slotById;
+    unordered_map<string, Inbox> inboxes;
+    NotificationRetention retention;
+    mutable mutex storeMutex;
+    size_t deadSlots;
+    size_t liveSlots;
+    size_t textBytes;           // recipient and message characters of live notifications
+    size_t highWaterBytes;
+    size_t totalRemoved;
+    size_t compactions;
+    bool compactRequested;      // set by a retention pass
+    int nextId;
+
+    void removeSlot(Inbox& inbox, size_t slot) {
+        Notification& note = notifications[slot];
+        if (!note.isRead) inbox.unread--;
+        textBytes -= note.recipient.size() + note.message.size();
+        slotById.erase(note.id);
+        string().swap(note.message);
+        note.removed = true;
+        deadSlots++;
+        liveSlots--;
+        totalRemoved++;
+    }
+
+    bool expired(const Notification& note, time_t now) const {
+        time_t age = now - note.sentTime;
+        if (retention.maxAgeDays > 0 && age > retention.maxAgeDays * 86400LL) return true;
+        return note.isRead && retention.readMaxAgeDays > 0 &&
+               age > retention.readMaxAgeDays * 86400LL;
+    }
+
+    // Packs live notifications to the front of the store and rewrites the
+    // slot references; ids stay the same
+    void compact() {
+        vector<size_t> newSlot(notifications.size());
+        size_t next = 0;
+        for (size_t slot = 0; slot < notifications.size(); ++slot) {
+            if (notifications[slot].removed) continue;
+            newSlot[slot] = next;
+            if (slot != next) notifications[next] = move(notifications[slot]);
+            next++;
+        }
+        notifications.resize(next);
+        notifications.shrink_to_fit();
+
+        for (auto& entry : slotById) entry.second = newSlot[entry.second];
+        slotById.rehash(0);
+        for (auto it = inboxes.begin(); it != inboxes.end(); ) {
+            if (it->second.slots.empty()) {
+                it = inboxes.erase(it);
+                continue;
+            }
+            for (size_t& slot : it->second.slots) slot = newSlot[slot];
+            ++it;
+        }
+        deadSlots = 0;
+        compactRequested = false;
+        compactions++;
+    }
+
+    // Every live notification is referenced from exactly one inbox slot,
+    // so liveSlots doubles as the slot reference count
+    size_t approximateBytes() const {
+        const size_t nodeOverhead = 2 * sizeof(void*);
+        return notifications.capacity() * sizeof(Notification) + textBytes +
+               slotById.size() * (sizeof(pair<const int, size_t>) + nodeOverhead) +
+               slotById.bucket_count() * sizeof(void*) +
+               inboxes.size() * (sizeof(pair<const string, Inbox>) + nodeOverhead) +
+               liveSlots * sizeof(size_t);
+    }
+
+    void updateHighWater() {
+        highWaterBytes = max(highWaterBytes, approximateBytes());
+    }
+
+public:
+    NotificationSystem()
+        : deadSlots(0), liveSlots(0), textBytes(0), highWaterBytes(0),
+          totalRemoved(0), compactions(0), compactRequested(false), nextId(1) {}
+
+    void setRetention(const NotificationRetention& policy) {
+        lock_guard<mutex> lock(storeMutex);
+        retention = policy;
+    }
+
+    NotificationRetention getRetention() const {
+        lock_guard<mutex> lock(storeMutex);
+        return retention;
+    }
+
+    static const char* typeLabel(NotificationType type) {
+        switch (type) {
+            case NotificationType::DUE_DATE_REMINDER: return "REMINDER";
+            case NotificationType::OVERDUE_NOTICE: return "OVERDUE";
+            case NotificationType::RESERVATION_AVAILABLE: return "RESERVATION";
+            case NotificationType::NEW_BOOK_ARRIVAL: return "NEW BOOK";
+            case NotificationType::GENERAL_ANNOUNCEMENT: return "ANNOUNCEMENT";
+        }
+        return "NOTICE";
+    }
+
+    // A zero sentTime means "now"
+    void sendNotification(const string& recipient, const string& message, 
+                         NotificationType type, time_t sentTime = 0) {
+        lock_guard<mutex> lock(storeMutex);
+        store(recipient, message, type, sentTime != 0 ? sentTime : LibraryUtils::now());
+    }
+
+    // Stores a whole batch under one lock
+    void sendNotifications(const vector<OutgoingNotification>& batch) {
+        lock_guard<mutex> lock(storeMutex);
+        for (const auto& note : batch) {
+            store(note.recipient, note.message, note.type, note.sentTime);
+        }
+    }
+
+private:
+    void store(const string& recipient, const string& message, 
+               NotificationType type, time_t sentTime) {
+        slotById[nextId] = notifications.size();
+        Inbox& inbox = inboxes[recipient];
+        inbox.slots.push_back(notifications.size());
+        inbox.unread++;
+        notifications.push_back({
+            nextId++,
+            recipient,
+            message,
+            sentTime,
+            type,
+            false,
+            false
+        });
+        textBytes += recipient.size() + message.size();
+        liveSlots++;
+
+        if (retention.maxPerUser > 0) {
+            while (inbox.slots.size() > retention.maxPerUser) {
+                removeSlot(inbox, inbox.slots.front());
+                inbox.slots.pop_front();
+            }
+        }
+        updateHighWater();
+    }
+
+public:
+    // Compacts the store when a retention pass asked for it, or when dead
+    // slots reach half the store (and at least
+    // NOTIFICATION_COMPACT_MIN_DEAD). Returns true if it compacted.
+    bool maintain() {
+        lock_guard<mutex> lock(storeMutex);
+        bool sparse = deadSlots >= NOTIFICATION_COMPACT_MIN_DEAD && deadSlots * 2 >= notifications.size();
+        if (deadSlots == 0 || !(sparse || compactRequested)) return false;
+        compact();
+        return true;
+    }
+
+    // Drops notifications past their retention age; the space is
+    // reclaimed by the next maintain(). Returns the number removed.
+    size_t applyRetention() {
+        time_t now = LibraryUtils::now();
+        lock_guard<mutex> lock(storeMutex);
+        size_t before = totalRemoved;
+        for (auto& entry : inboxes) {
+            Inbox& inbox = entry.second;
+            deque<size_t> kept;
+            for (size_t slot : inbox.slots) {
+                if (expired(notifications[slot], now)) {
+                    removeSlot(inbox, slot);
+                } else {
+                    kept.push_back(slot);
+                }
+            }
+            inbox.slots.swap(kept);
+        }
+        if (deadSlots > 0) compactRequested = true;
+        return totalRemoved - before;
+    }
+
+    // Live notifications in store order; removed slots are not written
+    void save(BinaryWriter& out) const {
+        lock_guard<mutex> lock(storeMutex);
+        out.write(nextId);
+        out.write(retention);
+        out.write(static_cast<uint32_t>(liveSlots));
+        for (const auto& note : notifications) {
+            if (note.removed) continue;
+            out.write(note.id);
+            out.write(note.recipient);
+            out.write(note.message);
+            out.write(note.sentTime);
+            out.write(note.type);
+            out.write(note.isRead);
+        }
+    }
+
+    void swap(NotificationSystem& other) {
+        scoped_lock lock(storeMutex, other.storeMutex);
+        notifications.swap(other.notifications);
+        slotById.swap(other.slotById);
+        inboxes.swap(other.inboxes);
+        std::swap(retention, other.retention);
+        std::swap(deadSlots, other.deadSlots);
+        std::swap(liveSlots, other.liveSlots);
+        std::swap(textBytes, other.textBytes);
+        std::swap(highWaterBytes, other.highWaterBytes);
+        std::swap(totalRemoved, other.totalRemoved);
+        std::swap(compactions, other.compactions);
+        std::swap(compactRequested, other.compactRequested);
+        std::swap(nextId, other.nextId);
+    }
+
+    // Replaces the whole store; ids are kept as saved
+    void load(BinaryReader& in) {
+        lock_guard<mutex> lock(storeMutex);
+        notifications.clear();
+        slotById.clear();
+        inboxes.clear();
+        deadSlots = liveSlots = textBytes = 0;
+        compactRequested = false;
+
+        int savedNextId = 1;
+        in.read(savedNextId);
+        in.read(retention);
+        uint32_t total = in.readCount(sizeof(int) + 2 * sizeof(uint32_t) + sizeof(time_t));
+        for (uint32_t i = 0; i < total && in.ok(); ++i) {
+            Notification note;
+            note.removed = false;
+            in.read(note.id);
+            in.read(note.recipient);
+            in.read(note.message);
+            in.read(note.sentTime);
+            in.read(note.type);
+            in.read(note.isRead);
+
+            slotById[note.id] = notifications.size();
+            Inbox& inbox = inboxes[note.recipient];
+            inbox.slots.push_back(notifications.size());
+            if (!note.isRead) inbox.unread++;
+            textBytes += note.recipient.size() + note.message.size();
+            liveSlots++;
+            notifications.push_back(move(note));
+        }
+        nextId = savedNextId;
+        updateHighWater();
+    }
+
+    NotificationStats getStats() const {
+        lock_guard<mutex> lock(storeMutex);
+        NotificationStats stats;
+        stats.liveNotifications = liveSlots;
+        stats.storeSlots = notifications.size();
+        stats.recipients = inboxes.size();
+        stats.approxBytes = approximateBytes();
+        stats.highWaterBytes = max(highWaterBytes, stats.approxBytes);
+        stats.totalRemoved = totalRemoved;
+        stats.compactions = compactions;
+        return stats;
+    }
+
+    void markAsRead(int notificationId) {
+        lock_guard<mutex> lock(storeMutex);
+        auto slot = slotById.find(notificationId);
+        if (slot == slotById.end()) return;
+        Notification& note = notifications[slot->second];
+        if (note.isRead) return;
+        note.isRead = true;
+        inboxes[note.recipient].unread--;
+    }
+
+    size_t getUnreadCount(const string& username) const {
+        lock_guard<mutex> lock(storeMutex);
+        auto inbox = inboxes.find(username);
+        return inbox == inboxes.end() ? 0 : inbox->second.unread;
+    }
+
+    vector<Notification> getUnreadNotifications(const string& username) const {
+        lock_guard<mutex> lock(storeMutex);
+        vector<Notification> unread;
+        auto inbox = inboxes.find(username);
+        if (inbox == inboxes.end() || inbox->second.unread == 0) return unread;
+        unread.reserve(inbox->second.unread);
+        for (size_t slot : inbox->second.slots) {
+            if (!notifications[slot].isRead) {
+                unread.push_back(notifications[slot]);
+            }
+        }
+        return unread;
+    }
+
+    vector<Notification> getAllNotifications(const string& username) const {
+        lock_guard<mutex> lock(storeMutex);
+        vector<Notification> userNotes;
+        auto inbox = inboxes.find(username);
+        if (inbox == inboxes.end()) return userNotes;
+        userNotes.reserve(inbox->second.slots.size());
+        for (size_t slot : inbox->second.slots) {
+            userNotes.push_back(notifications[slot]);
+        }
+        return userNotes;
+    }
+
+    void displayNotifications(const string& username) const {
+        lock_guard<mutex> lock(storeMutex);
+        auto inbox = inboxes.find(username);
+        if (inbox == inboxes.end() || inbox->second.slots.empty()) {
+            cout << "No notifications found.\n";
+            return;
+        }
+
+        cout << "Notifications for " << username << " (" << inbox->second.unread << " unread):\n";
+        cout << "----------------------------------------\n";
+        for (size_t slot : inbox->second.slots) {
+            const Notification& note = notifications[slot];
+            cout << "[" << LibraryUtils::formatTimestamp(note.sentTime) << "] ";
+            cout << typeLabel(note.type) << ": " << note.message << "\n";
+            cout << (note.isRead ? "(read)" : "(new)") << "\n\n";
+        }
+        cout << "----------------------------------------\n";
+    }
+};
+
+// Delivery target of the notification dispatcher. deliver() runs on the
+// dispatcher's worker thread, one batch at a time.
+class NotificationSink {
+public:
+    virtual ~NotificationSink() = default;
+    virtual void deliver(const vector<OutgoingNotification>& batch) = 0;
+
+    // Housekeeping; runs on the worker thread whenever the queue drains
+    virtual void maintain() {}
+};
+
+// In-memory sink: stores notifications in the users' inboxes
+class InboxSink : public NotificationSink {
+private:
+    NotificationSystem& inboxes;
+
+public:
+    explicit InboxSink(NotificationSystem& system) : inboxes(system) {}
+
+    void deliver(const vector<OutgoingNotification>& batch) override {
+        inboxes.sendNotifications(batch);
+    }
+
+    void maintain() override {
+        inboxes.maintain();
+    }
+};
+
+// Appends one tab-separated line per notification to a file
+class FileSink : public NotificationSink {
+private:
+    ofstream out;
+
+public:
+    explicit FileSink(const string& path) : out(path, ios::app) {
+        if (!out) cout << "Cannot open notification log " << path << ".\n";
+    }
+
+    void deliver(const vector<OutgoingNotification>& batch) override {
+        if (!out) return;
+        for (const auto& note : batch) {
+            out << LibraryUtils::formatTimestamp(note.sentTime) << '\t' << note.recipient << '\t'
+                << NotificationSystem::typeLabel(note.type) << '\t' << note.message << '\n';
+        }
+        out.flush();
+    }
+};
+
+// Streams the same lines as FileSink to a local (Unix domain) socket.
+// Not available on Windows; there the sink drops everything.
+class SocketSink : public NotificationSink {
+private:
+    int fd;
+
+public:
+    explicit SocketSink(const string& path) : fd(-1) {
+#ifndef _WIN32
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            cout << "Socket path too long: " << path << "\n";
+            return;
+        }
+        path.copy(addr.sun_path, path.size());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            fd = -1;
+        }
+        if (fd < 0) cout << "Cannot connect to notification socket " << path << ".\n";
+#else
+        cout << "Socket notification sink is not supported on this platform.\n";
+#endif
+    }
+
+    ~SocketSink() override {
+#ifndef _WIN32
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    SocketSink(const SocketSink&) = delete;
+    SocketSink& operator=(const SocketSink&) = delete;
+
+    void deliver(const vector<OutgoingNotification>& batch) override {
+#ifndef _WIN32
+        if (fd < 0) return;
+        string payload;
+        for (const auto& note : batch) {
+            payload += LibraryUtils::formatTimestamp(note.sentTime) + '\t' + note.recipient + '\t' +
+                       NotificationSystem::typeLabel(note.type) + '\t' + note.message + '\n';
+        }
+        size_t sent = 0;
+        while (sent < payload.size()) {
+            ssize_t n = send(fd, payload.data() + sent, payload.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                close(fd);
+                fd = -1;
+                return;
+            }
+            sent += static_cast<size_t>(n);
+        }
+#else
+        (void)batch;
+#endif
+    }
+};
+
+// Asynchronous notification delivery. Any thread may post; posting only
+// appends to a bounded queue (blocking while it is full). A single worker,
+// started by the first post, drains up to NOTIFICATION_BATCH_SIZE
+// notifications at a time and hands each batch to every sink. Once the
+// queue is empty (or when asked with requestMaintenance) the worker runs
+// each sink's maintain().
+class NotificationDispatcher {
+private:
+    deque<OutgoingNotification> queue;
+    mutex queueMutex;
+    condition_variable notEmpty;
+    condition_variable notFull;
+    condition_variable idle;
+    bool stopping;
+    bool busy;
+    bool maintenanceDue;
+
+    vector<unique_ptr<NotificationSink>> sinks;
+    mutex sinkMutex;
+
+    size_t delivered;
+    size_t batches;
+    once_flag started;
+    thread worker;
+
+    // Libraries that never notify (exports, benchmarks) never get a thread
+    void start() {
+        call_once(started, [this] { worker = thread(&NotificationDispatcher::run, this); });
+    }
+
+    void run() {
+        vector<OutgoingNotification> batch;
+        batch.reserve(NOTIFICATION_BATCH_SIZE);
+        bool maintain = false;
+        while (true) {
+            {
+                unique_lock<mutex> lock(queueMutex);
+                notEmpty.wait(lock, [this] { return stopping || maintenanceDue || !queue.empty(); });
+                if (queue.empty() && !maintenanceDue) break;   // stopping and drained
+                while (!queue.empty() && batch.size() < NOTIFICATION_BATCH_SIZE) {
+                    batch.push_back(move(queue.front()));
+                    queue.pop_front();
+                }
+                maintain = queue.empty();
+                maintenanceDue = false;
+                busy = true;
+            }
+            notFull.notify_all();
+
+            {
+                lock_guard<mutex> lock(sinkMutex);
+                if (!batch.empty()) {
+                    for (auto& sink : sinks) sink->deliver(batch);
+                }
+                if (maintain) {
+                    for (auto& sink : sinks) sink->maintain();
+                }
+            }
+
+            lock_guard<mutex> lock(queueMutex);
+            if (!batch.empty()) {
+                delivered += batch.size();
+                batches++;
+            }
+            batch.clear();
+            busy = false;
+            if (queue.empty()) idle.notify_all();
+        }
+    }
+
+public:
+    NotificationDispatcher()
+        : stopping(false), busy(false), maintenanceDue(false), delivered(0), batches(0) {}
+
+    // Delivers everything still queued before returning
+    ~NotificationDispatcher() {
+        if (!worker.joinable()) return;
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
+        }
+        notEmpty.notify_all();
+        worker.join();
+    }
+
+    NotificationDispatcher(const NotificationDispatcher&) = delete;
+    NotificationDispatcher& operator=(const NotificationDispatcher&) = delete;
+
+    void addSink(unique_ptr<NotificationSink> sink) {
+        lock_guard<mutex> lock(sinkMutex);
+        sinks.push_back(move(sink));
+    }
+
+    // The send time is taken now, on the caller's thread
+    void sendNotification(const string& recipient, const string& message, 
+                         NotificationType type) {
+        OutgoingNotification note{recipient, message, type, LibraryUtils::now()};
+        start();
+        {
+            unique_lock<mutex> lock(queueMutex);
+            notFull.wait(lock, [this] { return queue.size() < NOTIFICATION_QUEUE_CAPACITY; });
+            queue.push_back(move(note));
+        }
+        notEmpty.notify_one();
+    }
+
+    // Wakes the worker to run the sinks' maintain() even with nothing queued
+    void requestMaintenance() {
+        start();
+        {
+            lock_guard<mutex> lock(queueMutex);
+            maintenanceDue = true;
+        }
+        notEmpty.notify_one();
+    }
+
+    // Blocks until every posted notification has reached the sinks
+    void flush() {
+        unique_lock<mutex> lock(queueMutex);
+        idle.wait(lock, [this] { return queue.empty() && !busy && !maintenanceDue; });
+    }
+
+    size_t deliveredCount() {
+        lock_guard<mutex> lock(queueMutex);
+        return delivered;
+    }
+
+    size_t batchCount() {
+        lock_guard<mutex> lock(queueMutex);
+        return batches;
+    }
+};
+
+// Due-date scheduler: a min-heap of upcoming reminder/overdue events for
+// open loans only. Each daily run pops just the events that have come due.
+// Returned or renewed loans leave stale events behind; they are skipped
+// when popped.
+class DueDateScheduler {
+private:
+    enum class EventKind { DUE_TOMORROW, OVERDUE };
+
+    struct Event {
+        int day;           // day the event fires
+        size_t loan;       // index of the borrow transaction
+        int dueDay;        // due day the event was scheduled for
+        EventKind kind;
+
+        bool operator>(const Event& other) const { return day > other.day; }
+    };
+
+    priority_queue<Event, vector<Event>, greater<Event>> events;
+
+public:
+    void schedule(size_t loan, int dueDay) {
+        events.push({dueDay - 1, loan, dueDay, EventKind::DUE_TOMORROW});
+        events.push({dueDay + 1, loan, dueDay, EventKind::OVERDUE});
+    }
+
+    // Sends each "due tomorrow" reminder once and repeats overdue notices
+    // every OVERDUE_NOTICE_INTERVAL_DAYS until the book comes back.
+    void process(int today, const TransactionLog& transactions,
+                 const vector<string>& usernamesById, NotificationDispatcher& notifications) {
+        while (!events.empty() && events.top().day <= today) {
+            Event event = events.top();
+            events.pop();
+
+            const Transaction& trans = transactions[event.loan];
+            if (trans.getIsReturned() || trans.getDueDay() != event.dueDay) continue;
+            const string& username = usernamesById[trans.getUserId()];
+
+            if (event.kind == EventKind::DUE_TOMORROW) {
+                if (today == event.dueDay - 1) {
+                    notifications.sendNotification(username, 
+                        "Your borrowed book (ID: " + to_string(trans.getBookId()) + 
+                        ") is due tomorrow.", NotificationType::DUE_DATE_REMINDER);
+                }
+            } else {
+                notifications.sendNotification(username, 
+                    "Your borrowed book (ID: " + to_string(trans.getBookId()) + 
+                    ") is overdue by " + to_string(today - event.dueDay) + " days.", 
+                    NotificationType::OVERDUE_NOTICE);
+                events.push({today + OVERDUE_NOTICE_INTERVAL_DAYS, event.loan, event.dueDay,
+                             EventKind::OVERDUE});
+            }
+        }
+    }
+
+    size_t pendingEvents() const { return events.size(); }
+};
+
+// User Management
+class User {
+private:
+    int userId;
+    string username;
+    string password;
+    string fullName;
+    string email;
+    string joinDate;
+    vector<int> borrowedBooks;
+    vector<string> borrowingDates;
+    vector<string> dueDates;
+    vector<string> favoriteGenres;
+    int totalBooksBorrowed;
+    UserType type;
+    double balance;
+    vector<int> reservedBooks;
+    int loginAttempts;
+    string lastLogin;
+    bool isActive;
+    vector<string> readingHistory;
+    map<string, int> genrePreferences;
+    vector<string> wishlist;
+
+public:
+    User(string u, string p, string name, string email, 
+         UserType t = UserType::STANDARD)
+        : userId(0), username(u), password(p), fullName(name), email(email),
+          joinDate(LibraryUtils::getCurrentDateTime()), totalBooksBorrowed(0),
+          type(t), balance(0.0), loginAttempts(0), isActive(true) {}
+
+    explicit User(BinaryReader& in) {
+        in.read(userId);
+        in.read(username);
+        in.read(password);
+        in.read(fullName);
+        in.read(email);
+        in.read(joinDate);
+        in.read(borrowedBooks);
+        in.read(borrowingDates);
+        in.read(dueDates);
+        in.read(favoriteGenres);
+        in.read(totalBooksBorrowed);
+        in.read(type);
+        in.read(balance);
+        in.read(reservedBooks);
+        in.read(loginAttempts);
+        in.read(lastLogin);
+        in.read(isActive);
+        in.read(readingHistory);
+        in.read(genrePreferences);
+        in.read(wishlist);
+    }
+
+    void save(BinaryWriter& out) const {
+        out.write(userId);
+        out.write(username);
+        out.write(password);
+        out.write(fullName);
+        out.write(email);
+        out.write(joinDate);
+        out.write(borrowedBooks);
+        out.write(borrowingDates);
+        out.write(dueDates);
+        out.write(favoriteGenres);
+        out.write(totalBooksBorrowed);
+        out.write(type);
+        out.write(balance);
+        out.write(reservedBooks);
+        out.write(loginAttempts);
+        out.write(lastLogin);
+        out.write(isActive);
+        out.write(readingHistory);
+        out.write(genrePreferences);
+        out.write(wishlist);
+    }
+
+    bool authenticate(string u, string p) {
+        if (!isActive) {
+            cout << "Account is inactive.\n";
+            return false;
+        }
+        if (username == u && password == p) {
+            loginAttempts = 0;
+            lastLogin = LibraryUtils::getCurrentDateTime();
+            return true;
+        }
+        loginAttempts++;
+        if (loginAttempts >= MAX_LOGIN_ATTEMPTS) {
+            isActive = false;
+            cout << "Too many failed login attempts. Account locked.\n";
+        }
+        return false;
+    }
+
+    bool canBorrowMore() const {
+        int limit = MAX_BORROW_LIMIT;
+        switch (type) {
+            case UserType::PREMIUM: limit *= 2; break;
+                        case UserType::FACULTY: limit = 10; break;
+            case UserType::STAFF: limit = 8; break;
+            case UserType::GUEST: limit = 2; break;
+            default: break;
+        }
+        return borrowedBooks.size() < limit;
+    }
+
+    int getBorrowLimit() const {
+        switch (type) {
+            case UserType::PREMIUM: return MAX_BORROW_LIMIT * 2;
+            case UserType::FACULTY: return 10;
+            case UserType::STAFF: return 8;
+            case UserType::GUEST: return 2;
+            default: return MAX_BORROW_LIMIT;
+        }
+    }
+
+    bool borrowBook(int bookID, const string& dueDate = "") {
+        if (!canBorrowMore()) {
+            cout << "Borrow limit reached (" << getBorrowLimit() << " books). Please return some books first.\n";
+            return false;
+        }
+        if (find(borrowedBooks.begin(), borrowedBooks.end(), bookID) != borrowedBooks.end()) {
+            cout << "You've already borrowed this book.\n";
+            return false;
+        }
+        borrowedBooks.push_back(bookID);
+        borrowingDates.push_back(LibraryUtils::getCurrentDateTime());
+        dueDates.push_back(dueDate.empty() ? LibraryUtils::getCurrentDate() : dueDate);
+        totalBooksBorrowed++;
+        readingHistory.push_back("Borrowed book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
+        return true;
+    }
+
+    bool returnBook(int bookID) {
+        auto it = find(borrowedBooks.begin(), borrowedBooks.end(), bookID);
+        if (it != borrowedBooks.end()) {
+            size_t index = distance(borrowedBooks.begin(), it);
+            borrowedBooks.erase(it);
+            borrowingDates.erase(borrowingDates.begin() + index);
+            dueDates.erase(dueDates.begin() + index);
+            readingHistory.push_back("Returned book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
+            cout << "Book ID " << bookID << " returned successfully.\n";
+            return true;
+        }
+        cout << "Book not found in your borrowed list.\n";
+        return false;
+    }
+
+    void updateDueDate(int bookID, const string& dueDate) {
+        auto it = find(borrowedBooks.begin(), borrowedBooks.end(), bookID);
+        if (it != borrowedBooks.end()) {
+            dueDates[distance(borrowedBooks.begin(), it)] = dueDate;
+        }
+    }
+
+    bool reserveBook(int bookID) {
+        if (find(reservedBooks.begin(), reservedBooks.end(), bookID) != reservedBooks.end()) {
+            cout << "You've already reserved this book.\n";
+            return false;
+        }
+        reservedBooks.push_back(bookID);
+        readingHistory.push_back("Reserved book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
+        cout << "Book ID " << bookID << " reserved successfully.\n";
+        return true;
+    }
+
+    bool cancelReservation(int bookID) {
+        auto it = find(reservedBooks.begin(), reservedBooks.end(), bookID);
+        if (it != reservedBooks.end()) {
+            reservedBooks.erase(it);
+            readingHistory.push_back("Cancelled reservation for book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
+            cout << "Reservation for book ID " << bookID << " cancelled.\n";
+            return true;
+        }
+        cout << "No reservation found for this book.\n";
+        return false;
+    }
+
+    void displayBorrowedBooks() const {
+        if (borrowedBooks.empty()) {
+            cout << "No books currently borrowed.\n";
+            return;
+        }
+        cout << "Books currently borrowed by " << username << ":\n";
+        cout << "----------------------------------------\n";
+        for (size_t i = 0; i < borrowedBooks.size(); ++i) {
+            cout << "- Book ID: " << borrowedBooks[i] 
+                 << " (borrowed on " << borrowingDates[i] 
+                 << ", due on " << dueDates[i] << ")\n";
+        }
+        cout << "----------------------------------------\n";
+    }
+
+    void displayReservedBooks() const {
+        if (reservedBooks.empty()) {
+            cout << "No books currently reserved.\n";
+            return;
+        }
+        cout << "Books currently reserved by " << username << ":\n";
+        cout << "----------------------------------------\n";
+        for (const auto& bookID : reservedBooks) {
+            cout << "- Book ID: " << bookID << "\n";
+        }
+        cout << "----------------------------------------\n";
+    }
+
+    // Returns false if the genre was already a favorite. Go through
+    // Library::addFavoriteGenre so new-arrival notices reach the user.
+    bool addFavoriteGenre(const string& genre) {
+        string lowerGenre = LibraryUtils::toLower(genre);
+        if (find(favoriteGenres.begin(), favoriteGenres.end(), lowerGenre) != favoriteGenres.end()) {
+            return false;
+        }
+        favoriteGenres.push_back(lowerGenre);
+        genrePreferences[lowerGenre]++;
+        cout << "Added " << genre << " to favorite genres.\n";
+        return true;
+    }
+
+    void addToWishlist(const string& bookTitle) {
+        if (find(wishlist.begin(), wishlist.end(), bookTitle) == wishlist.end()) {
+            wishlist.push_back(bookTitle);
+            cout << "Added \"" << bookTitle << "\" to your wishlist.\n";
+        }
+    }
+
+    void displayProfile() const {
+        cout << "\nUser Profile for " << username << ":\n";
+        cout << "----------------------------------------\n";
+        cout << "Full Name: " << fullName << "\n";
+        cout << "Email: " << email << "\n";
+        cout << "Member Since: " << joinDate << "\n";
+        cout << "Last Login: " << (lastLogin.empty() ? "Never" : lastLogin) << "\n";
+        cout << "Account Type: ";
+        switch (type) {
             case UserType::STANDARD: cout << "Standard"; break;
             case UserType::PREMIUM: cout << "Premium"; break;
             case UserType::STUDENT: cout << "Student"; break;
@@ -1092,299 +4068,1508 @@ public:
             case UserType::GUEST: cout << "Guest"; break;
         }
         cout << "\n";
-        cout << "Account Status: " << (isActive ? "Active" : "Inactive") << "\n";
-        cout << "Total Books Borrowed: " << totalBooksBorrowed << "\n";
-        cout << "Currently Borrowed: " << borrowedBooks.size() << "/" << getBorrowLimit() << " books\n";
-        cout << "Currently Reserved: " << reservedBooks.size() << " books\n";
-        cout << "Balance Due: $" << fixed << setprecision(2) << balance << "\n";
-        cout << "Favorite Genres: ";
-        for (const auto& genre : favoriteGenres) cout << genre << ", ";
-        cout << "\n";
-        if (!wishlist.empty()) {
-            cout << "Wishlist: ";
-            for (const auto& item : wishlist) cout << "\"" << item << "\", ";
-            cout << "\n";
+        cout << "Account Status: " << (isActive ? "Active" : "Inactive") << "\n";
+        cout << "Total Books Borrowed: " << totalBooksBorrowed << "\n";
+        cout << "Currently Borrowed: " << borrowedBooks.size() << "/" << getBorrowLimit() << " books\n";
+        cout << "Currently Reserved: " << reservedBooks.size() << " books\n";
+        cout << "Balance Due: $" << fixed << setprecision(2) << balance << "\n";
+        cout << "Favorite Genres: ";
+        for (const auto& genre : favoriteGenres) cout << genre << ", ";
+        cout << "\n";
+        if (!wishlist.empty()) {
+            cout << "Wishlist: ";
+            for (const auto& item : wishlist) cout << "\"" << item << "\", ";
+            cout << "\n";
+        }
+        cout << "----------------------------------------\n";
+    }
+
+    void displayReadingHistory(int limit = 10) const {
+        if (readingHistory.empty()) {
+            cout << "No reading history available.\n";
+            return;
+        }
+        cout << "\nReading History for " << username << " (last " << limit << " entries):\n";
+        cout << "----------------------------------------\n";
+        int start = max(0, static_cast<int>(readingHistory.size()) - limit);
+        for (size_t i = start; i < readingHistory.size(); ++i) {
+            cout << "- " << readingHistory[i] << "\n";
+        }
+        cout << "----------------------------------------\n";
+    }
+
+    int getId() const { return userId; }
+    void setId(int id) { userId = id; }
+    string getUsername() const { return username; }
+    string getEmail() const { return email; }
+    string getFullName() const { return fullName; }
+    string getJoinDate() const { return joinDate; }
+    string getLastLogin() const { return lastLogin; }
+    int getTotalBooksBorrowed() const { return totalBooksBorrowed; }
+    const vector<string>& getFavoriteGenres() const { return favoriteGenres; }
+    UserType getType() const { return type; }
+    const vector<int>& getBorrowedBooks() const { return borrowedBooks; }
+    const vector<int>& getReservedBooks() const { return reservedBooks; }
+    double getBalance() const { return balance; }
+    bool getIsActive() const { return isActive; }
+
+    void upgradeAccount(UserType newType) {
+        type = newType;
+        cout << "Account upgraded to ";
+        switch (type) {
+            case UserType::PREMIUM: cout << "Premium"; break;
+            case UserType::STUDENT: cout << "Student"; break;
+            case UserType::FACULTY: cout << "Faculty"; break;
+            case UserType::STAFF: cout << "Staff"; break;
+            default: break;
+        }
+        cout << ". Your borrow limit is now " << getBorrowLimit() << " books.\n";
+    }
+
+    void addToBalance(double amount) {
+        balance += amount;
+        if (amount > 0) {
+            cout << "$" << fixed << setprecision(2) << amount << " added to your account.\n";
+        } else {
+            cout << "$" << fixed << setprecision(2) << -amount << " deducted from your account.\n";
+        }
+        cout << "New balance: $" << fixed << setprecision(2) << balance << "\n";
+    }
+
+    void activateAccount() {
+        isActive = true;
+        loginAttempts = 0;
+        cout << "Account activated successfully.\n";
+    }
+
+    void updatePassword(const string& newPassword) {
+        if (!LibraryUtils::validatePassword(newPassword)) {
+            cout << "Password must be at least 8 characters with uppercase, lowercase, numbers and special characters.\n";
+            return;
+        }
+        password = newPassword;
+        cout << "Password updated successfully.\n";
+    }
+
+    void updateEmail(const string& newEmail) {
+        if (!LibraryUtils::validateEmail(newEmail)) {
+            cout << "Invalid email format.\n";
+            return;
+        }
+        email = newEmail;
+        cout << "Email updated successfully.\n";
+    }
+};
+
+// Admin class
+class Admin {
+private:
+    string username;
+    string password;
+    string accessLevel; // "full", "limited", "support"
+    string fullName;
+    string email;
+    string lastLogin;
+    int loginAttempts;
+    bool isActive;
+    vector<string> activityLog;
+
+public:
+    Admin(string u, string p, string level = "limited", 
+          string name = "", string email = "")
+        : username(u), password(p), accessLevel(level),
+          fullName(name), email(email), loginAttempts(0), isActive(true) {}
+
+    explicit Admin(BinaryReader& in) {
+        in.read(username);
+        in.read(password);
+        in.read(accessLevel);
+        in.read(fullName);
+        in.read(email);
+        in.read(lastLogin);
+        in.read(loginAttempts);
+        in.read(isActive);
+        in.read(activityLog);
+    }
+
+    void save(BinaryWriter& out) const {
+        out.write(username);
+        out.write(password);
+        out.write(accessLevel);
+        out.write(fullName);
+        out.write(email);
+        out.write(lastLogin);
+        out.write(loginAttempts);
+        out.write(isActive);
+        out.write(activityLog);
+    }
+
+    bool authenticate(string u, string p) {
+        if (!isActive) {
+            cout << "Account is inactive.\n";
+            return false;
+        }
+        if (username == u && password == p) {
+            loginAttempts = 0;
+            lastLogin = LibraryUtils::getCurrentDateTime();
+            activityLog.push_back("Logged in on " + lastLogin);
+            return true;
+        }
+        loginAttempts++;
+        if (loginAttempts >= MAX_LOGIN_ATTEMPTS) {
+            isActive = false;
+            cout << "Too many failed login attempts. Account locked.\n";
+        }
+        return false;
+    }
+
+    bool hasFullAccess() const { return accessLevel == "full"; }
+    bool hasLimitedAccess() const { return accessLevel == "limited"; }
+    bool hasSupportAccess() const { return accessLevel == "support"; }
+
+    void removeBook(vector<unique_ptr<Book>>& books, CatalogIndex& catalog, int bookID) {
+        if (!hasFullAccess() && !hasLimitedAccess()) {
+            cout << "You don't have permission to remove books.\n";
+            return;
+        }
+        
+        Book* book = catalog.findById(bookID);
+        auto it = book ? find_if(books.begin(), books.end(), 
+            [book](const unique_ptr<Book>& b) { return b.get() == book; }) : books.end();
+        
+        if (it != books.end()) {
+            cout << "Removing book: " << (*it)->getTitle() << endl;
+            catalog.remove(bookID);
+            books.erase(it);
+            activityLog.push_back("Removed book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
+        } else {
+            cout << "Book ID " << bookID << " not found.\n";
+        }
+    }
+
+    void updateBookStatus(Book* book, BookStatus newStatus) {
+        if (!hasFullAccess() && !hasLimitedAccess()) {
+            cout << "You don't have permission to update book status.\n";
+            return;
+        }
+        book->updateStatus(newStatus);
+        activityLog.push_back("Updated status for book ID " + to_string(book->getId()) + " to " + to_string(static_cast<int>(newStatus)) + " on " + LibraryUtils::getCurrentDateTime());
+    }
+
+    void manageUserAccount(User& user, bool activate) {
+        if (!hasFullAccess() && !hasSupportAccess()) {
+            cout << "You don't have permission to manage user accounts.\n";
+            return;
+        }
+        if (activate) {
+            user.activateAccount();
+        } else {
+            // In a real system, we would deactivate here
+            cout << "Account deactivation would happen here.\n";
+        }
+        activityLog.push_back((activate ? "Activated" : "Deactivated") + string(" user ") + user.getUsername() + " on " + LibraryUtils::getCurrentDateTime());
+    }
+
+    void displaySystemStats(const CatalogIndex& catalog, 
+                          const unordered_map<string, User>& users) const {
+        if (!hasFullAccess() && !hasLimitedAccess()) {
+            cout << "You don't have permission to view system stats.\n";
+            return;
+        }
+        
+        cout << "\nLibrary System Statistics:\n";
+        cout << "----------------------------------------\n";
+        cout << "Total Books: " << catalog.size() << "\n";
+        
+        const CatalogColumns& columns = catalog.getColumns();
+        map<string, int> typeCounts = columns.typeCounts();
+        map<string, int> genreCounts = columns.genreCounts();
+        map<string, int> statusCounts;
+        long long totalBorrows = columns.totalBorrows();
+        int availableBooks = 0;
+
+        for (const auto& pair : columns.statusCounts()) {
+            statusCounts[to_string(static_cast<int>(pair.first))] = pair.second;
+            if (pair.first == BookStatus::AVAILABLE) availableBooks = pair.second;
+        }
+        
+        cout << "Available Books: " << availableBooks << "\n";
+        cout << "\nBooks by Type:\n";
+        for (const auto& pair : typeCounts) {
+            cout << "- " << pair.first << ": " << pair.second << "\n";
+        }
+        
+        cout << "\nBooks by Genre:\n";
+        for (const auto& pair : genreCounts) {
+            cout << "- " << pair.first << ": " << pair.second << "\n";
+        }
+        
+        cout << "\nBooks by Status:\n";
+        for (const auto& pair : statusCounts) {
+            cout << "- " << pair.first << ": " << pair.second << "\n";
+        }
+        
+        cout << "\nTotal Users: " << users.size() << "\n";
+        
+        map<UserType, int> userTypeCounts;
+        int activeUsers = 0;
+        for (const auto& pair : users) {
+            userTypeCounts[pair.second.getType()]++;
+            if (pair.second.getIsActive()) activeUsers++;
+        }
+        
+        cout << "Active Users: " << activeUsers << "\n";
+        cout << "\nUsers by Type:\n";
+        for (const auto& pair : userTypeCounts) {
+            cout << "- ";
+            switch (pair.first) {
+                case UserType::STANDARD: cout << "Standard"; break;
+                case UserType::PREMIUM: cout << "Premium"; break;
+                case UserType::STUDENT: cout << "Student"; break;
+                case UserType::FACULTY: cout << "Faculty"; break;
+                case UserType::STAFF: cout << "Staff"; break;
+                case UserType::GUEST: cout << "Guest"; break;
+            }
+            cout << ": " << pair.second << "\n";
+        }
+        
+        cout << "\nTotal Book Borrows: " << totalBorrows << "\n";
+        cout << "----------------------------------------\n";
+    }
+
+    void displayActivityLog(int limit = 20) const {
+        cout << "\nAdmin Activity Log for " << username << ":\n";
+        cout << "----------------------------------------\n";
+        int start = max(0, static_cast<int>(activityLog.size()) - limit);
+        for (size_t i = start; i < activityLog.size(); ++i) {
+            cout << "- " << activityLog[i] << "\n";
+        }
+        cout << "----------------------------------------\n";
+    }
+
+    string getUsername() const { return username; }
+    string getAccessLevel() const { return accessLevel; }
+    bool getIsActive() const { return isActive; }
+
+    void updateAccessLevel(const string& newLevel) {
+        if (newLevel != "full" && newLevel != "limited" && newLevel != "support") {
+            cout << "Invalid access level. Must be 'full', 'limited', or 'support'.\n";
+            return;
+        }
+        accessLevel = newLevel;
+        cout << "Access level updated to " << newLevel << ".\n";
+    }
+
+    void updatePassword(const string& newPassword) {
+        if (!LibraryUtils::validatePassword(newPassword)) {
+            cout << "Password must be at least 8 characters with uppercase, lowercase, numbers and special characters.\n";
+            return;
+        }
+        password = newPassword;
+        cout << "Password updated successfully.\n";
+    }
+};
+
+// Write-ahead log. Each record is framed as {payload size, FNV-1a 32
+// checksum, sequence number} followed by the payload. Appends go to an
+// in-memory batch; a flusher thread writes the batch and fsyncs it once,
+// so every caller waiting during that sync shares it (group commit).
+class WriteAheadLog {
+private:
+    struct RecordHeader {
+        uint32_t size;
+        uint32_t checksum;
+        uint64_t lsn;
+    };
+
+    int fd;
+    string pending;             // framed records not yet written
+    size_t pendingRecords;
+    uint64_t lastLsn;           // last sequence number handed out
+    uint64_t durableLsn;        // last sequence number known to be on disk
+    bool stopping;
+    bool failed;
+    size_t maxBatchRecords;
+    int batchDelayMicros;
+    uint64_t recordsWritten;
+    uint64_t syncs;
+    mutex logMutex;
+    condition_variable work;
+    condition_variable durable;
+    thread flusher;
+
+    static uint32_t checksumOf(uint64_t lsn, const char* data, size_t size) {
+        uint32_t hash = 2166136261u;
+        const unsigned char* lsnBytes = reinterpret_cast<const unsigned char*>(&lsn);
+        for (size_t i = 0; i < sizeof(lsn); ++i) hash = (hash ^ lsnBytes[i]) * 16777619u;
+        for (size_t i = 0; i < size; ++i) hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+        return hash;
+    }
+
+    static bool writeAll(int file, const char* data, size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            int n = _write(file, data, static_cast<unsigned int>(min<size_t>(size, 1 << 30)));
+#else
+            ssize_t n = ::write(file, data, size);
+#endif
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    static bool syncFile(int file) {
+#ifdef _WIN32
+        return _commit(file) == 0;
+#else
+        return fsync(file) == 0;
+#endif
+    }
+
+    void run() {
+        unique_lock<mutex> lock(logMutex);
+        while (true) {
+            work.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) break;     // stopping and drained
+            if (batchDelayMicros > 0 && pendingRecords < maxBatchRecords && !stopping) {
+                work.wait_for(lock, chrono::microseconds(batchDelayMicros),
+                              [this] { return stopping || pendingRecords >= maxBatchRecords; });
+            }
+
+            string batch;
+            batch.swap(pending);
+            size_t records = pendingRecords;
+            uint64_t batchLsn = lastLsn;
+            pendingRecords = 0;
+
+            lock.unlock();
+            bool written = writeAll(fd, batch.data(), batch.size()) && syncFile(fd);
+            lock.lock();
+
+            if (!written) failed = true;
+            durableLsn = batchLsn;
+            recordsWritten += records;
+            syncs++;
+            durable.notify_all();
+        }
+    }
+
+public:
+    WriteAheadLog()
+        : fd(-1), pendingRecords(0), lastLsn(0), durableLsn(0), stopping(false), failed(false),
+          maxBatchRecords(WAL_GROUP_COMMIT_MAX_RECORDS), batchDelayMicros(WAL_GROUP_COMMIT_DELAY_MICROS),
+          recordsWritten(0), syncs(0) {}
+
+    ~WriteAheadLog() { close(); }
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Calls apply(lsn, payload) for each intact record in order. Stops at
+    // the first torn or corrupt record; validBytes is where it starts.
+    // Returns the last sequence number read.
+    static uint64_t replay(const string& path, const function<void(uint64_t, const string&)>& apply,
+                           uint64_t& validBytes) {
+        validBytes = 0;
+        uint64_t last = 0;
+        ifstream in(path, ios::binary);
+        if (!in) return 0;
+        in.seekg(0, ios::end);
+        uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+        in.seekg(0, ios::beg);
+
+        RecordHeader header;
+        string payload;
+        while (in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            if (header.size > fileSize - validBytes - sizeof(header)) break;
+            payload.resize(header.size);
+            if (header.size > 0 && !in.read(&payload[0], header.size)) break;
+            if (header.lsn <= last || checksumOf(header.lsn, payload.data(), payload.size()) != header.checksum) break;
+            apply(header.lsn, payload);
+            last = header.lsn;
+            validBytes += sizeof(header) + header.size;
+        }
+        return last;
+    }
+
+    // Opens the log for appending after a replay: drops any torn tail past
+    // validBytes and continues numbering after startLsn
+    bool open(const string& path, uint64_t validBytes, uint64_t startLsn) {
+        close();
+#ifdef _WIN32
+        fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+        if (fd >= 0 && _chsize_s(fd, static_cast<__int64>(validBytes)) != 0) {
+#else
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd >= 0 && ftruncate(fd, static_cast<off_t>(validBytes)) != 0) {
+#endif
+            close();
+        }
+        if (fd < 0) {
+            cout << "Cannot open write-ahead log " << path << ".\n";
+            return false;
+        }
+        lastLsn = durableLsn = startLsn;
+        stopping = failed = false;
+        flusher = thread(&WriteAheadLog::run, this);
+        return true;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Flushes what is queued, stops the flusher and closes the file
+    void close() {
+        if (flusher.joinable()) {
+            {
+                lock_guard<mutex> lock(logMutex);
+                stopping = true;
+            }
+            work.notify_all();
+            flusher.join();
+        }
+        if (fd >= 0) {
+#ifdef _WIN32
+            _close(fd);
+#else
+            ::close(fd);
+#endif
+            fd = -1;
+        }
+    }
+
+    // maxRecords caps a batch; delayMicros > 0 lets the flusher wait that
+    // long for a batch to fill before syncing
+    void setGroupCommit(size_t maxRecords, int delayMicros) {
+        lock_guard<mutex> lock(logMutex);
+        maxBatchRecords = max<size_t>(maxRecords, 1);
+        batchDelayMicros = delayMicros;
+    }
+
+    // Queues a record and returns its sequence number; thread-safe
+    uint64_t append(const string& payload) {
+        lock_guard<mutex> lock(logMutex);
+        RecordHeader header;
+        header.size = static_cast<uint32_t>(payload.size());
+        header.lsn = ++lastLsn;
+        header.checksum = checksumOf(header.lsn, payload.data(), payload.size());
+        pending.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        pending.append(payload);
+        pendingRecords++;
+        if (pendingRecords == 1 || pendingRecords >= maxBatchRecords) work.notify_one();
+        return header.lsn;
+    }
+
+    // Blocks until the record is on disk; false if the log failed
+    bool waitDurable(uint64_t lsn) {
+        unique_lock<mutex> lock(logMutex);
+        durable.wait(lock, [&] { return durableLsn >= lsn || fd < 0; });
+        return !failed && durableLsn >= lsn;
+    }
+
+    // Empties the log once a snapshot holds everything in it; numbering
+    // continues so replay can skip records the snapshot already covers
+    bool checkpoint() {
+        if (fd < 0) return false;
+        unique_lock<mutex> lock(logMutex);
+        durable.wait(lock, [this] { return pending.empty() && durableLsn == lastLsn; });
+#ifdef _WIN32
+        bool truncated = _chsize_s(fd, 0) == 0;
+#else
+        bool truncated = ftruncate(fd, 0) == 0;
+#endif
+        return truncated && syncFile(fd);
+    }
+
+    uint64_t getLastLsn() {
+        lock_guard<mutex> lock(logMutex);
+        return lastLsn;
+    }
+
+    uint64_t getRecordsWritten() {
+        lock_guard<mutex> lock(logMutex);
+        return recordsWritten;
+    }
+
+    uint64_t getSyncCount() {
+        lock_guard<mutex> lock(logMutex);
+        return syncs;
+    }
+};
+
+// Read-only catalog image for kiosk processes. The file is a header,
+// fixed-width book records, open-addressing hash tables for id and ISBN
+// lookups, and a heap of deduplicated strings. Everything is addressed by
+// file offset, so the image is mapped and used as is: opening it costs a
+// few page faults, and processes mapping the same file share its pages.
+// The file ends with an FNV-1a checksum, checked only by verify().
+struct CatalogImageString {
+    uint32_t offset;    // into the string heap
+    uint32_t length;
+};
+
+struct CatalogImageRecord {
+    uint64_t isbnKey;   // normalized ISBN, 0 if the ISBN does not validate
+    double ratingTotal;
+    int32_t id;
+    int32_t year;
+    int32_t borrowCount;
+    int32_t ratingCount;
+    CatalogImageString title;
+    CatalogImageString author;
+    CatalogImageString isbn;
+    CatalogImageString publicationDate;
+    CatalogImageString publisher;
+    CatalogImageString language;
+    CatalogImageString edition;
+    CatalogImageString location;
+    CatalogImageString genre;
+    CatalogImageString type;
+    CatalogImageString description;
+    uint8_t status;
+    uint8_t format;
+    uint8_t padding[6];
+};
+static_assert(sizeof(CatalogImageRecord) == 128, "catalog image records are fixed-width");
+
+struct CatalogImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t bookCount;
+    uint32_t idSlots;       // power of two; slot holds record index + 1, 0 if empty
+    uint32_t isbnSlots;
+    uint64_t recordsOffset;
+    uint64_t idTableOffset;
+    uint64_t isbnTableOffset;
+    uint64_t heapOffset;
+    uint64_t heapSize;
+    int64_t builtAt;
+};
+
+class CatalogImage {
+private:
+    const char* data;
+    size_t size;
+    const CatalogImageHeader* header;
+    const CatalogImageRecord* records;
+    const uint32_t* idTable;
+    const uint32_t* isbnTable;
+    const char* heap;
+    vector<char> copy;      // file contents where mapping is not available
+#ifndef _WIN32
+    void* mapping;
+#endif
+
+    static size_t slotOf(uint64_t key, uint32_t slots) {
+        key *= 0x9e3779b97f4a7c15ULL;
+        return static_cast<size_t>(key ^ (key >> 32)) & (slots - 1);
+    }
+
+    static uint32_t tableSize(size_t count) {
+        uint32_t slots = 1;
+        while (slots < count * 2) slots <<= 1;
+        return slots;
+    }
+
+    static void insert(vector<uint32_t>& table, uint64_t key, uint32_t index) {
+        size_t slot = slotOf(key, static_cast<uint32_t>(table.size()));
+        while (table[slot] != 0) slot = (slot + 1) & (table.size() - 1);
+        table[slot] = index + 1;
+    }
+
+    // Probes a table; matches(record) decides whether the slot is the key
+    template <typename Match>
+    const CatalogImageRecord* probe(const uint32_t* table, uint32_t slots, uint64_t key, Match matches) const {
+        size_t slot = slotOf(key, slots);
+        for (uint32_t tries = 0; tries < slots; ++tries) {
+            uint32_t entry = table[slot];
+            if (entry == 0 || entry > header->bookCount) return nullptr;
+            if (matches(records[entry - 1])) return &records[entry - 1];
+            slot = (slot + 1) & (slots - 1);
+        }
+        return nullptr;
+    }
+
+    // Checks that the header describes a file of this size
+    bool validate() const {
+        if (size < sizeof(CatalogImageHeader) + sizeof(uint64_t)) return false;
+        const CatalogImageHeader& h = *reinterpret_cast<const CatalogImageHeader*>(data);
+        if (memcmp(h.magic, CATALOG_IMAGE_MAGIC, sizeof(h.magic)) != 0 || h.version != CATALOG_IMAGE_VERSION) {
+            return false;
+        }
+        if ((h.idSlots & (h.idSlots - 1)) != 0 || (h.isbnSlots & (h.isbnSlots - 1)) != 0 ||
+            h.idSlots == 0 || h.isbnSlots == 0) {
+            return false;
+        }
+        uint64_t body = size - sizeof(uint64_t);
+        return h.recordsOffset % alignof(CatalogImageRecord) == 0 &&
+               h.recordsOffset + static_cast<uint64_t>(h.bookCount) * sizeof(CatalogImageRecord) <= h.idTableOffset &&
+               h.idTableOffset % alignof(uint32_t) == 0 &&
+               h.idTableOffset + static_cast<uint64_t>(h.idSlots) * sizeof(uint32_t) <= h.isbnTableOffset &&
+               h.isbnTableOffset % alignof(uint32_t) == 0 &&
+               h.isbnTableOffset + static_cast<uint64_t>(h.isbnSlots) * sizeof(uint32_t) <= h.heapOffset &&
+               h.heapOffset + h.heapSize == body;
+    }
+
+public:
+    CatalogImage() : data(nullptr), size(0), header(nullptr), records(nullptr), idTable(nullptr),
+                     isbnTable(nullptr), heap(nullptr) {
+#ifndef _WIN32
+        mapping = nullptr;
+#endif
+    }
+
+    ~CatalogImage() { close(); }
+
+    CatalogImage(const CatalogImage&) = delete;
+    CatalogImage& operator=(const CatalogImage&) = delete;
+
+    // Writes an image of the given books. It is written beside the old
+    // file and renamed over it, so processes that still map the old image
+    // keep a consistent view until they reopen.
+    static bool build(const string& path, const vector<unique_ptr<Book>>& books) {
+        string strings;
+        unordered_map<string, uint32_t> stringOffsets;
+        auto addString = [&](const string& text) {
+            CatalogImageString ref;
+            ref.length = static_cast<uint32_t>(text.size());
+            auto it = stringOffsets.find(text);
+            if (it != stringOffsets.end()) {
+                ref.offset = it->second;
+            } else {
+                ref.offset = static_cast<uint32_t>(strings.size());
+                stringOffsets.emplace(text, ref.offset);
+                strings += text;
+            }
+            return ref;
+        };
+
+        vector<CatalogImageRecord> records(books.size());
+        vector<uint32_t> idTable(tableSize(books.size()), 0);
+        vector<uint32_t> isbnTable(tableSize(books.size()), 0);
+        for (size_t i = 0; i < books.size(); ++i) {
+            const Book& book = *books[i];
+            CatalogImageRecord& record = records[i];
+            memset(&record, 0, sizeof(record));
+            if (!LibraryUtils::normalizeISBN(book.getISBN(), record.isbnKey)) record.isbnKey = 0;
+            record.ratingTotal = book.getRatingTotal();
+            record.id = book.getId();
+            record.year = book.getYear();
+            record.borrowCount = book.getBorrowCount();
+            record.ratingCount = book.getRatingCount();
+            record.title = addString(book.getTitle());
+            record.author = addString(book.getAuthor());
+            record.isbn = addString(book.getISBN());
+            record.publicationDate = addString(book.getPublicationDate());
+            record.publisher = addString(book.getPublisher());
+            record.language = addString(book.getLanguage());
+            record.edition = addString(book.getEdition());
+            record.location = addString(book.getLocation());
+            record.genre = addString(book.getGenre());
+            record.type = addString(book.getBookType());
+            record.description = addString(book.getDescription());
+            record.status = static_cast<uint8_t>(book.getStatus());
+            record.format = static_cast<uint8_t>(book.getFormat());
+            insert(idTable, static_cast<uint32_t>(record.id), static_cast<uint32_t>(i));
+            if (record.isbnKey != 0) insert(isbnTable, record.isbnKey, static_cast<uint32_t>(i));
+        }
+        if (strings.size() > UINT32_MAX) {
+            cout << "Catalog too large for an image.\n";
+            return false;
+        }
+
+        CatalogImageHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CATALOG_IMAGE_MAGIC, sizeof(header.magic));
+        header.version = CATALOG_IMAGE_VERSION;
+        header.bookCount = static_cast<uint32_t>(records.size());
+        header.idSlots = static_cast<uint32_t>(idTable.size());
+        header.isbnSlots = static_cast<uint32_t>(isbnTable.size());
+        header.recordsOffset = sizeof(header);
+        header.idTableOffset = header.recordsOffset + records.size() * sizeof(CatalogImageRecord);
+        header.isbnTableOffset = header.idTableOffset + idTable.size() * sizeof(uint32_t);
+        header.heapOffset = header.isbnTableOffset + isbnTable.size() * sizeof(uint32_t);
+        header.heapSize = strings.size();
+        header.builtAt = static_cast<int64_t>(LibraryUtils::now());
+
+        string tempPath = path + ".tmp";
+        BinaryWriter out(tempPath);
+        if (!out.ok()) {
+            cout << "Cannot write catalog image " << tempPath << ".\n";
+            return false;
+        }
+        out.write(header);
+        out.writeBytes(records.data(), records.size() * sizeof(CatalogImageRecord));
+        out.writeBytes(idTable.data(), idTable.size() * sizeof(uint32_t));
+        out.writeBytes(isbnTable.data(), isbnTable.size() * sizeof(uint32_t));
+        out.writeBytes(strings.data(), strings.size());
+        if (!out.finish()) {
+            cout << "Failed to write catalog image " << tempPath << ".\n";
+            return false;
+        }
+#ifdef _WIN32
+        remove(path.c_str());
+#endif
+        if (rename(tempPath.c_str(), path.c_str()) != 0) {
+            cout << "Failed to replace catalog image " << path << ".\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Maps the image read-only. Only the header is checked here; string
+    // references are bounds-checked as they are read.
+    bool open(const string& path) {
+        close();
+#ifdef _WIN32
+        // No mapping on this platform; read the file instead
+        ifstream in(path, ios::binary);
+        if (!in) {
+            cout << "Cannot open catalog image " << path << ".\n";
+            return false;
+        }
+        in.seekg(0, ios::end);
+        copy.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0, ios::beg);
+        in.read(copy.data(), copy.size());
+        data = copy.data();
+        size = copy.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            if (fd >= 0) ::close(fd);
+            cout << "Cannot open catalog image " << path << ".\n";
+            return false;
+        }
+        size = static_cast<size_t>(info.st_size);
+        if (size > 0) {
+            mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED) mapping = nullptr;
+        }
+        ::close(fd);
+        data = static_cast<const char*>(mapping);
+#endif
+        if (!data || !validate()) {
+            cout << "Invalid catalog image " << path << ".\n";
+            close();
+            return false;
+        }
+        header = reinterpret_cast<const CatalogImageHeader*>(data);
+        records = reinterpret_cast<const CatalogImageRecord*>(data + header->recordsOffset);
+        idTable = reinterpret_cast<const uint32_t*>(data + header->idTableOffset);
+        isbnTable = reinterpret_cast<const uint32_t*>(data + header->isbnTableOffset);
+        heap = data + header->heapOffset;
+        return true;
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (mapping) munmap(mapping, size);
+        mapping = nullptr;
+#endif
+        vector<char>().swap(copy);
+        data = nullptr;
+        size = 0;
+        header = nullptr;
+        records = nullptr;
+        idTable = isbnTable = nullptr;
+        heap = nullptr;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+
+    // Recomputes the trailing checksum; reads every page of the image
+    bool verify() const {
+        if (!isOpen()) return false;
+        uint64_t checksum = 0xcbf29ce484222325ULL;
+        size_t body = size - sizeof(uint64_t);
+        for (size_t i = 0; i < body; ++i) {
+            checksum = (checksum ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+        }
+        uint64_t stored;
+        memcpy(&stored, data + body, sizeof(stored));
+        return stored == checksum;
+    }
+
+    size_t bookCount() const { return header ? header->bookCount : 0; }
+    time_t builtAt() const { return header ? static_cast<time_t>(header->builtAt) : 0; }
+
+    const CatalogImageRecord& record(size_t index) const { return records[index]; }
+
+    string_view text(const CatalogImageString& ref) const {
+        if (static_cast<uint64_t>(ref.offset) + ref.length > header->heapSize) return string_view();
+        return string_view(heap + ref.offset, ref.length);
+    }
+
+    const CatalogImageRecord* findById(int bookId) const {
+        if (!isOpen()) return nullptr;
+        return probe(idTable, header->idSlots, static_cast<uint32_t>(bookId),
+                     [bookId](const CatalogImageRecord& record) { return record.id == bookId; });
+    }
+
+    const CatalogImageRecord* findByISBN(const string& isbn) const {
+        uint64_t key;
+        if (!isOpen() || !LibraryUtils::normalizeISBN(isbn, key)) return nullptr;
+        return probe(isbnTable, header->isbnSlots, key,
+                     [key](const CatalogImageRecord& record) { return record.isbnKey == key; });
+    }
+
+    // Case-insensitive title/author substring scan over the records. The
+    // mapped text is compared in place; only the query is lowercased.
+    vector<const CatalogImageRecord*> search(const string& query, size_t limit) const {
+        vector<const CatalogImageRecord*> results;
+        string needle = LibraryUtils::toLower(query);
+        auto sameLetter = [](char a, char b) {
+            return tolower(static_cast<unsigned char>(a)) == static_cast<unsigned char>(b);
+        };
+        for (size_t i = 0; i < bookCount() && results.size() < limit; ++i) {
+            for (const CatalogImageString* ref : {&records[i].title, &records[i].author}) {
+                string_view value = text(*ref);
+                if (std::search(value.begin(), value.end(), needle.begin(), needle.end(), sameLetter) != value.end()) {
+                    results.push_back(&records[i]);
+                    break;
+                }
+            }
+        }
+        return results;
+    }
+
+    void displayBook(const CatalogImageRecord& record) const {
+        cout << "Title: " << text(record.title) << "\n";
+        cout << "Author: " << text(record.author) << "\n";
+        cout << "ID: " << record.id << " | ISBN: " << text(record.isbn) << "\n";
+        cout << "Type: " << text(record.type) << " | Genre: " << text(record.genre) << "\n";
+        cout << "Publisher: " << text(record.publisher) << " (" << record.year << ", "
+             << text(record.edition) << " edition) | Language: " << text(record.language) << "\n";
+        cout << "Location: " << text(record.location) << " | Status: ";
+        switch (static_cast<BookStatus>(record.status)) {
+            case BookStatus::AVAILABLE: cout << "Available"; break;
+            case BookStatus::BORROWED: cout << "Borrowed"; break;
+            case BookStatus::RESERVED: cout << "Reserved"; break;
+            case BookStatus::LOST: cout << "Lost"; break;
+            case BookStatus::DAMAGED: cout << "Damaged"; break;
+            case BookStatus::UNDER_MAINTENANCE: cout << "Under Maintenance"; break;
+        }
+        cout << "\n";
+        if (record.ratingCount > 0) {
+            cout << "Average Rating: " << fixed << setprecision(1) << record.ratingTotal / record.ratingCount
+                 << "/5 (" << record.ratingCount << " ratings)\n";
+        }
+        if (record.description.length > 0) cout << text(record.description) << "\n";
+        cout << "----------------------------------------\n";
+    }
+};
+
+// Bulk catalog import from CSV. The header row names the columns (any
+// order, unknown ones ignored); type, title, author, isbn and
+// publication_date are required. Quoted fields may contain commas, doubled
+// quotes and line breaks. The file is read in large chunks that are cut at
+// record boundaries and parsed and validated on several threads. Books are
+// built afterwards on the caller's thread, since they intern strings.
+enum ImportColumn {
+    COL_TYPE, COL_TITLE, COL_AUTHOR, COL_ISBN, COL_PUBLICATION_DATE,
+    COL_PUBLISHER, COL_LANGUAGE, COL_DESCRIPTION, COL_LOCATION, COL_EDITION,
+    COL_YEAR, COL_TAGS, COL_FORMAT,
+    COL_FILE_SIZE_MB, COL_WORD_COUNT, COL_DRM, COL_DOWNLOAD_LINK,
+    COL_PAGES, COL_BINDING, COL_DIMENSIONS, COL_WEIGHT, COL_ILLUSTRATED, COL_CONDITION,
+    COL_SUBGENRE, COL_MAGIC_SYSTEM, COL_WORLD, COL_SERIES_NAME, COL_SERIES_NUMBER,
+    COL_SUBJECT, COL_FIELD, COL_CLASSIFICATION, COL_EDITION_YEAR, COL_EXERCISES, COL_COURSE_CODE,
+    IMPORT_COLUMN_COUNT
+};
+
+const char* const IMPORT_COLUMN_NAMES[IMPORT_COLUMN_COUNT] = {
+    "type", "title", "author", "isbn", "publication_date",
+    "publisher", "language", "description", "location", "edition",
+    "year", "tags", "format",
+    "file_size_mb", "word_count", "drm", "download_link",
+    "pages", "binding", "dimensions", "weight", "illustrated", "condition",
+    "subgenre", "magic_system", "world", "series_name", "series_number",
+    "subject", "field", "classification", "edition_year", "exercises", "course_code"
+};
+
+struct ImportRow {
+    size_t number;          // data row in the file, starting at 1
+    vector<string> fields;  // indexed by ImportColumn
+    string error;           // empty if the row validated
+};
+
+class CatalogImporter {
+private:
+    ifstream in;
+    string path;
+    vector<int> layout;     // file column -> ImportColumn, -1 if ignored
+    string carry;           // start of a record cut off by the last chunk
+    size_t rowsRead;
+    unsigned threads;
+
+    static bool parseInt(const string& text, int& value) {
+        if (text.empty()) return false;
+        char* end;
+        errno = 0;
+        long parsed = strtol(text.c_str(), &end, 10);
+        if (*end != '\0' || errno != 0 || parsed < INT_MIN || parsed > INT_MAX) return false;
+        value = static_cast<int>(parsed);
+        return true;
+    }
+
+    static bool parseDouble(const string& text, double& value) {
+        if (text.empty()) return false;
+        char* end;
+        value = strtod(text.c_str(), &end);
+        return *end == '\0' && isfinite(value);
+    }
+
+    static bool parseBool(const string& text, bool& value) {
+        string lower = LibraryUtils::toLower(text);
+        if (lower == "1" || lower == "true" || lower == "yes") value = true;
+        else if (lower == "0" || lower == "false" || lower == "no") value = false;
+        else return false;
+        return true;
+    }
+
+    static bool parseKind(const string& text, SnapshotBookKind& kind) {
+        string lower = LibraryUtils::toLower(text);
+        if (lower == "ebook") kind = SnapshotBookKind::EBOOK;
+        else if (lower == "printed") kind = SnapshotBookKind::PRINTED_BOOK;
+        else if (lower == "fantasy") kind = SnapshotBookKind::FANTASY_NOVEL;
+        else if (lower == "textbook") kind = SnapshotBookKind::SCIENCE_TEXTBOOK;
+        else return false;
+        return true;
+    }
+
+    static bool parseFormat(const string& text, BookFormat& format) {
+        string lower = LibraryUtils::toLower(text);
+        if (lower == "hardcover") format = BookFormat::HARDCOVER;
+        else if (lower == "paperback") format = BookFormat::PAPERBACK;
+        else if (lower == "pdf") format = BookFormat::EBOOK_PDF;
+        else if (lower == "epub") format = BookFormat::EBOOK_EPUB;
+        else if (lower == "mobi") format = BookFormat::EBOOK_MOBI;
+        else if (lower == "audiobook") format = BookFormat::AUDIOBOOK;
+        else return false;
+        return true;
+    }
+
+    static string orDefault(const string& value, const string& fallback) {
+        return value.empty() ? fallback : value;
+    }
+
+    static int intOr(const string& text, int fallback) {
+        int value;
+        return parseInt(text, value) ? value : fallback;
+    }
+
+    static double doubleOr(const string& text, double fallback) {
+        double value;
+        return parseDouble(text, value) ? value : fallback;
+    }
+
+    static bool boolOr(const string& text, bool fallback) {
+        bool value;
+        return parseBool(text, value) ? value : fallback;
+    }
+
+    // Splits one record (no trailing newline) into fields
+    static void splitRecord(const char* begin, const char* end, vector<string>& fields) {
+        fields.clear();
+        const char* p = begin;
+        while (true) {
+            string field;
+            if (p < end && *p == '"') {
+                for (++p; p < end; ++p) {
+                    if (*p == '"') {
+                        if (p + 1 < end && p[1] == '"') ++p;
+                        else { ++p; break; }
+                    }
+                    field += *p;
+                }
+                while (p < end && *p != ',') ++p;   // text after a closing quote is dropped
+            } else {
+                const char* start = p;
+                while (p < end && *p != ',') ++p;
+                field.assign(start, p);
+            }
+            fields.push_back(move(field));
+            if (p >= end) break;
+            ++p;    // comma
         }
-        cout << "----------------------------------------\n";
     }
 
-    void displayReadingHistory(int limit = 10) const {
-        if (readingHistory.empty()) {
-            cout << "No reading history available.\n";
-            return;
+    // Checks the values a book needs and normalizes the ISBN to its digits
+    static string validate(vector<string>& fields) {
+        for (int column : {COL_TITLE, COL_AUTHOR, COL_ISBN, COL_PUBLICATION_DATE}) {
+            if (fields[column].empty()) return string("Missing ") + IMPORT_COLUMN_NAMES[column] + ".";
+        }
+        SnapshotBookKind kind;
+        if (!parseKind(fields[COL_TYPE], kind)) return "Unknown book type: " + fields[COL_TYPE];
+        uint64_t isbnKey;
+        if (!LibraryUtils::normalizeISBN(fields[COL_ISBN], isbnKey)) return "Invalid ISBN: " + fields[COL_ISBN];
+        string digits;
+        for (char c : fields[COL_ISBN]) {
+            if (c != '-' && c != ' ') digits += c;
+        }
+        fields[COL_ISBN] = digits;
+
+        int number;
+        double real;
+        bool flag;
+        BookFormat format;
+        for (int column : {COL_YEAR, COL_WORD_COUNT, COL_PAGES, COL_SERIES_NUMBER, COL_EDITION_YEAR}) {
+            if (!fields[column].empty() && !parseInt(fields[column], number)) {
+                return string("Bad number in ") + IMPORT_COLUMN_NAMES[column] + ": " + fields[column];
+            }
         }
-        cout << "\nReading History for " << username << " (last " << limit << " entries):\n";
-        cout << "----------------------------------------\n";
-        int start = max(0, static_cast<int>(readingHistory.size()) - limit);
-        for (size_t i = start; i < readingHistory.size(); ++i) {
-            cout << "- " << readingHistory[i] << "\n";
+        for (int column : {COL_FILE_SIZE_MB, COL_WEIGHT}) {
+            if (!fields[column].empty() && !parseDouble(fields[column], real)) {
+                return string("Bad number in ") + IMPORT_COLUMN_NAMES[column] + ": " + fields[column];
+            }
         }
-        cout << "----------------------------------------\n";
+        for (int column : {COL_DRM, COL_ILLUSTRATED, COL_MAGIC_SYSTEM, COL_EXERCISES}) {
+            if (!fields[column].empty() && !parseBool(fields[column], flag)) {
+                return string("Bad yes/no value in ") + IMPORT_COLUMN_NAMES[column] + ": " + fields[column];
+            }
+        }
+        if (!fields[COL_FORMAT].empty() && !parseFormat(fields[COL_FORMAT], format)) {
+            return "Unknown format: " + fields[COL_FORMAT];
+        }
+        return "";
     }
 
-    string getUsername() const { return username; }
-    string getEmail() const { return email; }
-    UserType getType() const { return type; }
-    const vector<int>& getBorrowedBooks() const { return borrowedBooks; }
-    const vector<int>& getReservedBooks() const { return reservedBooks; }
-    double getBalance() const { return balance; }
-    bool getIsActive() const { return isActive; }
-
-    void upgradeAccount(UserType newType) {
-        type = newType;
-        cout << "Account upgraded to ";
-        switch (type) {
-            case UserType::PREMIUM: cout << "Premium"; break;
-            case UserType::STUDENT: cout << "Student"; break;
-            case UserType::FACULTY: cout << "Faculty"; break;
-            case UserType::STAFF: cout << "Staff"; break;
-            default: break;
+    // Parses the records in [begin, end) into rows, in file order
+    void parseRange(const char* begin, const char* end, vector<ImportRow>& rows) const {
+        vector<string> raw;
+        const char* p = begin;
+        while (p < end) {
+            const char* recordEnd = p;
+            bool quoted = false;
+            while (recordEnd < end && (quoted || *recordEnd != '\n')) {
+                if (*recordEnd == '"') quoted = !quoted;
+                ++recordEnd;
+            }
+            const char* contentEnd = recordEnd;
+            if (contentEnd > p && contentEnd[-1] == '\r') --contentEnd;
+            if (contentEnd > p) {
+                splitRecord(p, contentEnd, raw);
+                ImportRow row;
+                row.number = 0;
+                row.fields.resize(IMPORT_COLUMN_COUNT);
+                for (size_t i = 0; i < raw.size() && i < layout.size(); ++i) {
+                    if (layout[i] >= 0) row.fields[layout[i]] = move(raw[i]);
+                }
+                if (raw.size() != layout.size()) {
+                    row.error = "Expected " + to_string(layout.size()) + " fields, found " + to_string(raw.size()) + ".";
+                } else {
+                    row.error = validate(row.fields);
+                }
+                rows.push_back(move(row));
+            }
+            p = recordEnd + 1;
         }
-        cout << ". Your borrow limit is now " << getBorrowLimit() << " books.\n";
     }
 
-    void addToBalance(double amount) {
-        balance += amount;
-        if (amount > 0) {
-            cout << "$" << fixed << setprecision(2) << amount << " added to your account.\n";
-        } else {
-            cout << "$" << fixed << setprecision(2) << -amount << " deducted from your account.\n";
+public:
+    explicit CatalogImporter(const string& file)
+        : path(file), rowsRead(0), threads(max(1u, thread::hardware_concurrency())) {}
+
+    // Opens the file and maps its header onto the known columns
+    bool open() {
+        in.open(path, ios::binary);
+        if (!in) {
+            cout << "Cannot open import file " << path << ".\n";
+            return false;
         }
-        cout << "New balance: $" << fixed << setprecision(2) << balance << "\n";
+        string header;
+        getline(in, header);
+        if (!header.empty() && header.back() == '\r') header.pop_back();
+        if (header.size() >= 3 && header.compare(0, 3, "\xEF\xBB\xBF") == 0) header.erase(0, 3);
+
+        vector<string> names;
+        splitRecord(header.data(), header.data() + header.size(), names);
+        layout.assign(names.size(), -1);
+        vector<bool> present(IMPORT_COLUMN_COUNT, false);
+        for (size_t i = 0; i < names.size(); ++i) {
+            string name = LibraryUtils::toLower(LibraryUtils::trim(names[i]));
+            for (int column = 0; column < IMPORT_COLUMN_COUNT; ++column) {
+                if (name == IMPORT_COLUMN_NAMES[column]) {
+                    layout[i] = column;
+                    present[column] = true;
+                }
+            }
+        }
+        for (int column : {COL_TYPE, COL_TITLE, COL_AUTHOR, COL_ISBN, COL_PUBLICATION_DATE}) {
+            if (!present[column]) {
+                cout << "Import file " << path << " has no " << IMPORT_COLUMN_NAMES[column] << " column.\n";
+                return false;
+            }
+        }
+        return true;
     }
 
-    void activateAccount() {
-        isActive = true;
-        loginAttempts = 0;
-        cout << "Account activated successfully.\n";
-    }
+    // Reads and parses the next chunk of rows; false once the file is done
+    bool nextBatch(vector<ImportRow>& rows) {
+        rows.clear();
+        string chunk;
+        chunk.swap(carry);
+        size_t start = chunk.size();
+        chunk.resize(start + IMPORT_CHUNK_BYTES);
+        in.read(&chunk[start], IMPORT_CHUNK_BYTES);
+        chunk.resize(start + static_cast<size_t>(in.gcount()));
+        bool atEnd = !in;
+        if (chunk.empty()) return false;
+
+        // One quote-aware pass finds the record boundaries used to cut the
+        // chunk into per-thread ranges, and the last complete record
+        vector<size_t> cuts(1, 0);
+        size_t step = chunk.size() / threads + 1;
+        size_t complete = 0;
+        bool quoted = false;
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            if (chunk[i] == '"') quoted = !quoted;
+            else if (chunk[i] == '\n' && !quoted) {
+                complete = i + 1;
+                if (complete >= cuts.back() + step) cuts.push_back(complete);
+            }
+        }
+        if (atEnd) complete = chunk.size();
+        carry.assign(chunk, complete, string::npos);
+        if (cuts.back() != complete) cuts.push_back(complete);
 
-    void updatePassword(const string& newPassword) {
-        if (!LibraryUtils::validatePassword(newPassword)) {
-            cout << "Password must be at least 8 characters with uppercase, lowercase, numbers and special characters.\n";
-            return;
+        size_t ranges = cuts.size() - 1;
+        vector<vector<ImportRow>> parsed(ranges);
+        vector<thread> workers;
+        for (size_t r = 1; r < ranges; ++r) {
+            workers.emplace_back(&CatalogImporter::parseRange, this, chunk.data() + cuts[r],
+                                 chunk.data() + cuts[r + 1], ref(parsed[r]));
         }
-        password = newPassword;
-        cout << "Password updated successfully.\n";
+        if (ranges > 0) parseRange(chunk.data() + cuts[0], chunk.data() + cuts[1], parsed[0]);
+        for (auto& worker : workers) worker.join();
+
+        for (auto& part : parsed) {
+            for (auto& row : part) {
+                row.number = ++rowsRead;
+                rows.push_back(move(row));
+            }
+        }
+        return !rows.empty() || !atEnd;
     }
 
-    void updateEmail(const string& newEmail) {
-        if (!LibraryUtils::validateEmail(newEmail)) {
-            cout << "Invalid email format.\n";
-            return;
+    // Builds the book a validated row describes. Interns strings, so it
+    // must not run concurrently with other StringPool use.
+    static unique_ptr<Book> build(const ImportRow& row) {
+        const vector<string>& f = row.fields;
+        SnapshotBookKind kind = SnapshotBookKind::PRINTED_BOOK;
+        parseKind(f[COL_TYPE], kind);
+        BookFormat format = BookFormat::PAPERBACK;
+        if (kind == SnapshotBookKind::EBOOK) format = BookFormat::EBOOK_EPUB;
+        if (!f[COL_FORMAT].empty()) parseFormat(f[COL_FORMAT], format);
+        string publisher = orDefault(f[COL_PUBLISHER], "Unknown");
+        string language = orDefault(f[COL_LANGUAGE], "English");
+        string edition = orDefault(f[COL_EDITION], "1st");
+        int year = intOr(f[COL_YEAR], 0);
+
+        unique_ptr<Book> book;
+        switch (kind) {
+            case SnapshotBookKind::EBOOK:
+                book = make_unique<EBook>(f[COL_TITLE], f[COL_AUTHOR], 0, f[COL_ISBN], f[COL_PUBLICATION_DATE],
+                                          format, doubleOr(f[COL_FILE_SIZE_MB], 0), intOr(f[COL_WORD_COUNT], 0),
+                                          boolOr(f[COL_DRM], false), f[COL_DOWNLOAD_LINK], publisher, language,
+                                          f[COL_DESCRIPTION], orDefault(f[COL_LOCATION], "Digital"), edition, year);
+                break;
+            case SnapshotBookKind::PRINTED_BOOK:
+                book = make_unique<PrintedBook>(f[COL_TITLE], f[COL_AUTHOR], 0, f[COL_ISBN], f[COL_PUBLICATION_DATE],
+                                                format, intOr(f[COL_PAGES], 0), f[COL_BINDING], f[COL_DIMENSIONS],
+                                                doubleOr(f[COL_WEIGHT], 0), boolOr(f[COL_ILLUSTRATED], false),
+                                                orDefault(f[COL_CONDITION], "Good"), publisher, language,
+                                                f[COL_DESCRIPTION], orDefault(f[COL_LOCATION], "Stacks"), edition, year);
+                break;
+            case SnapshotBookKind::FANTASY_NOVEL:
+                book = make_unique<FantasyNovel>(f[COL_TITLE], f[COL_AUTHOR], 0, f[COL_ISBN], f[COL_PUBLICATION_DATE],
+                                                 f[COL_SUBGENRE], boolOr(f[COL_MAGIC_SYSTEM], false), f[COL_WORLD],
+                                                 publisher, language, f[COL_DESCRIPTION],
+                                                 orDefault(f[COL_LOCATION], "Fantasy"), edition, year,
+                                                 !f[COL_SERIES_NAME].empty(), f[COL_SERIES_NAME],
+                                                 intOr(f[COL_SERIES_NUMBER], 0));
+                break;
+            case SnapshotBookKind::SCIENCE_TEXTBOOK:
+                book = make_unique<ScienceTextbook>(f[COL_TITLE], f[COL_AUTHOR], 0, f[COL_ISBN], f[COL_PUBLICATION_DATE],
+                                                    f[COL_SUBJECT], f[COL_FIELD], f[COL_CLASSIFICATION],
+                                                    intOr(f[COL_EDITION_YEAR], 0),
+                                                    orDefault(f[COL_PUBLISHER], "Academic Press"), language,
+                                                    f[COL_DESCRIPTION], orDefault(f[COL_LOCATION], "Textbooks"),
+                                                    edition, year, boolOr(f[COL_EXERCISES], true), f[COL_COURSE_CODE]);
+                break;
         }
-        email = newEmail;
-        cout << "Email updated successfully.\n";
+        stringstream tags(f[COL_TAGS]);
+        string tag;
+        while (getline(tags, tag, ';')) book->addTag(tag);
+        return book;
     }
 };
 
-// Admin class
-class Admin {
+enum class ExportFormat {
+    JSON_LINES,
+    CSV
+};
+
+// Streams flat records to a JSON Lines or CSV file through one large
+// buffer. Fields are given in column order; CSV files start with a header
+// row, JSON objects use the column names as keys. List fields become JSON
+// arrays, or ';'-separated values in CSV.
+class ExportWriter {
 private:
-    string username;
-    string password;
-    string accessLevel; // "full", "limited", "support"
-    string fullName;
-    string email;
-    string lastLogin;
-    int loginAttempts;
-    bool isActive;
-    vector<string> activityLog;
+    ofstream out;
+    ExportFormat format;
+    vector<string> columns;
+    vector<char> buffer;
+    size_t used;
+    size_t column;      // next column of the current record
+    size_t records;
+
+    void flushBuffer() {
+        out.write(buffer.data(), used);
+        used = 0;
+    }
 
-public:
-    Admin(string u, string p, string level = "limited", 
-          string name = "", string email = "")
-        : username(u), password(p), accessLevel(level),
-          fullName(name), email(email), loginAttempts(0), isActive(true) {}
+    void put(char c) {
+        if (used == buffer.size()) flushBuffer();
+        buffer[used++] = c;
+    }
 
-    bool authenticate(string u, string p) {
-        if (!isActive) {
-            cout << "Account is inactive.\n";
-            return false;
-        }
-        if (username == u && password == p) {
-            loginAttempts = 0;
-            lastLogin = LibraryUtils::getCurrentDateTime();
-            activityLog.push_back("Logged in on " + lastLogin);
-            return true;
-        }
-        loginAttempts++;
-        if (loginAttempts >= MAX_LOGIN_ATTEMPTS) {
-            isActive = false;
-            cout << "Too many failed login attempts. Account locked.\n";
+    void append(const char* data, size_t size) {
+        while (size > 0) {
+            if (used == buffer.size()) flushBuffer();
+            size_t chunk = min(size, buffer.size() - used);
+            memcpy(buffer.data() + used, data, chunk);
+            used += chunk;
+            data += chunk;
+            size -= chunk;
         }
-        return false;
     }
 
-    bool hasFullAccess() const { return accessLevel == "full"; }
-    bool hasLimitedAccess() const { return accessLevel == "limited"; }
-    bool hasSupportAccess() const { return accessLevel == "support"; }
+    void appendJsonString(const string& value) {
+        put('"');
+        for (char c : value) {
+            switch (c) {
+                case '"': append("\\\"", 2); break;
+                case '\\': append("\\\\", 2); break;
+                case '\n': append("\\n", 2); break;
+                case '\r': append("\\r", 2); break;
+                case '\t': append("\\t", 2); break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                        append(escaped, 6);
+                    } else {
+                        put(c);
+                    }
+            }
+        }
+        put('"');
+    }
 
-    void removeBook(vector<unique_ptr<Book>>& books, int bookID) {
-        if (!hasFullAccess() && !hasLimitedAccess()) {
-            cout << "You don't have permission to remove books.\n";
+    void appendCsvString(const string& value) {
+        if (value.find_first_of(",\"\r\n") == string::npos) {
+            append(value.data(), value.size());
             return;
         }
-        
-        auto it = find_if(books.begin(), books.end(), 
-            [bookID](const unique_ptr<Book>& b) { return b->getId() == bookID; });
-        
-        if (it != books.end()) {
-            cout << "Removing book: " << (*it)->getTitle() << endl;
-            books.erase(it);
-            activityLog.push_back("Removed book ID " + to_string(bookID) + " on " + LibraryUtils::getCurrentDateTime());
-        } else {
-            cout << "Book ID " << bookID << " not found.\n";
+        put('"');
+        for (char c : value) {
+            if (c == '"') put('"');
+            put(c);
         }
+        put('"');
     }
 
-    void addBook(vector<unique_ptr<Book>>& books, unique_ptr<Book> book) {
-        if (!hasFullAccess() && !hasLimitedAccess()) {
-            cout << "You don't have permission to add books.\n";
-            return;
-        }
-        if (books.size() >= MAX_BOOKS_IN_LIBRARY) {
-            cout << "Library capacity reached. Cannot add more books.\n";
-            return;
+    // Separator and, for JSON, the key of the next field
+    void beginField() {
+        if (format == ExportFormat::JSON_LINES) {
+            put(column == 0 ? '{' : ',');
+            appendJsonString(columns[column]);
+            put(':');
+        } else if (column > 0) {
+            put(',');
         }
-        books.push_back(move(book));
-        activityLog.push_back("Added book ID " + to_string(books.back()->getId()) + " on " + LibraryUtils::getCurrentDateTime());
-        cout << "Book added successfully.\n";
+        column++;
     }
 
-    void updateBookStatus(Book* book, BookStatus newStatus) {
-        if (!hasFullAccess() && !hasLimitedAccess()) {
-            cout << "You don't have permission to update book status.\n";
-            return;
+    void appendNumber(const char* text) { append(text, strlen(text)); }
+
+public:
+    ExportWriter(const string& path, ExportFormat f, const vector<string>& names)
+        : out(path, ios::binary | ios::trunc), format(f), columns(names), buffer(EXPORT_BUFFER_SIZE),
+          used(0), column(0), records(0) {
+        if (format == ExportFormat::CSV) {
+            for (const auto& name : columns) field(name);
+            column = 0;
+            put('\n');
         }
-        book->updateStatus(newStatus);
-        activityLog.push_back("Updated status for book ID " + to_string(book->getId()) + " to " + to_string(static_cast<int>(newStatus)) + " on " + LibraryUtils::getCurrentDateTime());
     }
 
-    void manageUserAccount(User& user, bool activate) {
-        if (!hasFullAccess() && !hasSupportAccess()) {
-            cout << "You don't have permission to manage user accounts.\n";
+    bool ok() const { return static_cast<bool>(out); }
+
+    void field(const string& value) {
+        beginField();
+        if (format == ExportFormat::JSON_LINES) appendJsonString(value);
+        else appendCsvString(value);
+    }
+
+    void field(const char* value) { field(string(value)); }
+
+    void field(long long value) {
+        beginField();
+        char text[24];
+        snprintf(text, sizeof(text), "%lld", value);
+        appendNumber(text);
+    }
+
+    void field(int value) { field(static_cast<long long>(value)); }
+
+    void field(double value) {
+        beginField();
+        char text[32];
+        if (isfinite(value)) snprintf(text, sizeof(text), "%.10g", value);
+        else strcpy(text, format == ExportFormat::JSON_LINES ? "null" : "");
+        appendNumber(text);
+    }
+
+    void field(bool value) {
+        beginField();
+        appendNumber(value ? "true" : "false");
+    }
+
+    // A column this record does not have: null in JSON, an empty CSV cell
+    void nullField() {
+        beginField();
+        appendNumber(format == ExportFormat::JSON_LINES ? "null" : "");
+    }
+
+    void field(const vector<string>& values) {
+        if (format == ExportFormat::CSV) {
+            string joined;
+            for (size_t i = 0; i < values.size(); ++i) joined += (i ? ";" : "") + values[i];
+            field(joined);
             return;
         }
-        if (activate) {
-            user.activateAccount();
-        } else {
-            // In a real system, we would deactivate here
-            cout << "Account deactivation would happen here.\n";
+        beginField();
+        put('[');
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i) put(',');
+            appendJsonString(values[i]);
         }
-        activityLog.push_back((activate ? "Activated" : "Deactivated") + string(" user ") + user.getUsername() + " on " + LibraryUtils::getCurrentDateTime());
+        put(']');
     }
 
-    void displaySystemStats(const vector<unique_ptr<Book>>& books, 
-                          const unordered_map<string, User>& users) const {
-        if (!hasFullAccess() && !hasLimitedAccess()) {
-            cout << "You don't have permission to view system stats.\n";
+    void field(const vector<int>& values) {
+        vector<string> text;
+        for (int value : values) text.push_back(to_string(value));
+        if (format == ExportFormat::CSV) {
+            field(text);
             return;
         }
-        
-        cout << "\nLibrary System Statistics:\n";
-        cout << "----------------------------------------\n";
-        cout << "Total Books: " << books.size() << "\n";
-        
-        map<string, int> typeCounts;
-        map<string, int> genreCounts;
-        map<string, int> statusCounts;
-        int totalBorrows = 0;
-        int availableBooks = 0;
-        
-        for (const auto& book : books) {
-            typeCounts[book->getBookType()]++;
-            genreCounts[book->getGenre()]++;
-            statusCounts[to_string(static_cast<int>(book->getStatus()))]++;
-            totalBorrows += book->getBorrowCount();
-            if (book->getStatus() == BookStatus::AVAILABLE) availableBooks++;
-        }
-        
-        cout << "Available Books: " << availableBooks << "\n";
-        cout << "\nBooks by Type:\n";
-        for (const auto& pair : typeCounts) {
-            cout << "- " << pair.first << ": " << pair.second << "\n";
-        }
-        
-        cout << "\nBooks by Genre:\n";
-        for (const auto& pair : genreCounts) {
-            cout << "- " << pair.first << ": " << pair.second << "\n";
-        }
-        
-        cout << "\nBooks by Status:\n";
-        for (const auto& pair : statusCounts) {
-            cout << "- " << pair.first << ": " << pair.second << "\n";
-        }
-        
-        cout << "\nTotal Users: " << users.size() << "\n";
-        
-        map<UserType, int> userTypeCounts;
-        int activeUsers = 0;
-        for (const auto& pair : users) {
-            userTypeCounts[pair.second.getType()]++;
-            if (pair.second.getIsActive()) activeUsers++;
-        }
-        
-        cout << "Active Users: " << activeUsers << "\n";
-        cout << "\nUsers by Type:\n";
-        for (const auto& pair : userTypeCounts) {
-            cout << "- ";
-            switch (pair.first) {
-                case UserType::STANDARD: cout << "Standard"; break;
-                case UserType::PREMIUM: cout << "Premium"; break;
-                case UserType::STUDENT: cout << "Student"; break;
-                case UserType::FACULTY: cout << "Faculty"; break;
-                case UserType::STAFF: cout << "Staff"; break;
-                case UserType::GUEST: cout << "Guest"; break;
-            }
-            cout << ": " << pair.second << "\n";
+        beginField();
+        put('[');
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (i) put(',');
+            append(text[i].data(), text[i].size());
         }
-        
-        cout << "\nTotal Book Borrows: " << totalBorrows << "\n";
-        cout << "----------------------------------------\n";
+        put(']');
     }
 
-    void displayActivityLog(int limit = 20) const {
-        cout << "\nAdmin Activity Log for " << username << ":\n";
-        cout << "----------------------------------------\n";
-        int start = max(0, static_cast<int>(activityLog.size()) - limit);
-        for (size_t i = start; i < activityLog.size(); ++i) {
-            cout << "- " << activityLog[i] << "\n";
-        }
-        cout << "----------------------------------------\n";
+    void endRecord() {
+        if (format == ExportFormat::JSON_LINES) put('}');
+        put('\n');
+        column = 0;
+        records++;
     }
 
-    string getUsername() const { return username; }
-    string getAccessLevel() const { return accessLevel; }
-    bool getIsActive() const { return isActive; }
+    size_t recordCount() const { return records; }
 
-    void updateAccessLevel(const string& newLevel) {
-        if (newLevel != "full" && newLevel != "limited" && newLevel != "support") {
-            cout << "Invalid access level. Must be 'full', 'limited', or 'support'.\n";
-            return;
-        }
-        accessLevel = newLevel;
-        cout << "Access level updated to " << newLevel << ".\n";
+    // Flushes and closes; false on any I/O error
+    bool finish() {
+        flushBuffer();
+        out.close();
+        return !out.fail();
     }
+};
 
-    void updatePassword(const string& newPassword) {
-        if (!LibraryUtils::validatePassword(newPassword)) {
-            cout << "Password must be at least 8 characters with uppercase, lowercase, numbers and special characters.\n";
-            return;
-        }
-        password = newPassword;
-        cout << "Password updated successfully.\n";
+// Names the exporters write; the type and format names are the ones the
+// importer reads
+const char* exportName(BookFormat format) {
+    switch (format) {
+        case BookFormat::HARDCOVER: return "hardcover";
+        case BookFormat::PAPERBACK: return "paperback";
+        case BookFormat::EBOOK_PDF: return "pdf";
+        case BookFormat::EBOOK_EPUB: return "epub";
+        case BookFormat::EBOOK_MOBI: return "mobi";
+        case BookFormat::AUDIOBOOK: return "audiobook";
     }
+    return "unknown";
+}
+
+const char* exportName(BookStatus status) {
+    switch (status) {
+        case BookStatus::AVAILABLE: return "available";
+        case BookStatus::BORROWED: return "borrowed";
+        case BookStatus::RESERVED: return "reserved";
+        case BookStatus::LOST: return "lost";
+        case BookStatus::DAMAGED: return "damaged";
+        case BookStatus::UNDER_MAINTENANCE: return "under_maintenance";
+    }
+    return "unknown";
+}
+
+const char* exportName(UserType type) {
+    switch (type) {
+        case UserType::STANDARD: return "standard";
+        case UserType::PREMIUM: return "premium";
+        case UserType::STUDENT: return "student";
+        case UserType::FACULTY: return "faculty";
+        case UserType::STAFF: return "staff";
+        case UserType::GUEST: return "guest";
+    }
+    return "unknown";
+}
+
+const char* exportBookType(const Book& book) {
+    if (dynamic_cast<const FantasyNovel*>(&book)) return "fantasy";
+    if (dynamic_cast<const ScienceTextbook*>(&book)) return "textbook";
+    if (dynamic_cast<const EBook*>(&book)) return "ebook";
+    return "printed";
+}
+
+// Operations recorded in the write-ahead log
+enum class WalOp : uint8_t {
+    ADD_BOOK,
+    REMOVE_BOOK,
+    UPDATE_BOOK_STATUS,
+    REGISTER_USER,
+    BORROW,
+    RETURN,
+    RENEW,
+    RESERVE,
+    CANCEL_RESERVATION,
+    REVIEW,
+    ADD_FAVORITE_GENRE,
+    ADD_TO_BALANCE,
+    IMPORT_BOOKS
 };
 
 // Library class
 class Library {
 private:
     vector<unique_ptr<Book>> books;
+    CatalogIndex catalog;
     unordered_map<string, User> users;
     vector<Admin> admins;
-    vector<Transaction> transactions;
+    vector<string> usernamesById;   // user id -> username; slot 0 unused
+    unordered_map<Symbol, vector<int>> genreSubscribers;   // lowercased genre -> user ids
+    TransactionLog transactions;
+    unordered_map<LoanKey, size_t> openLoans;   // -> position in transactions
     NotificationSystem notificationSystem;
+    mutable NotificationDispatcher dispatcher;   // delivers into notificationSystem
+    DueDateScheduler dueDates;
     int nextBookId;
     int nextUserId;
     int nextAdminId;
@@ -1394,12 +5579,370 @@ private:
     string establishedDate;
     map<string, int> genrePopularity;
     vector<string> libraryHours;
+    WriteAheadLog wal;
+    uint64_t appliedLsn;    // last logged operation reflected in memory
+    int logBatchDepth;      // > 0: logged operations do not wait for the disk
+    bool replaying;
+
+    // Start of a log record: operation and the time it happened
+    BinaryWriter logRecord(WalOp op) const {
+        BinaryWriter record;
+        record.write(op);
+        record.write(LibraryUtils::now());
+        return record;
+    }
+
+    // Logs a validated operation before it is applied and, outside a
+    // batch, waits until the record is durable. False means the log failed
+    // and the operation must not be applied. Does nothing while replaying
+    // or when no log is open.
+    bool logOperation(const BinaryWriter& record) {
+        if (replaying || !wal.isOpen()) return true;
+        appliedLsn = wal.append(record.bytes());
+        if (logBatchDepth > 0) return true;
+        if (!wal.waitDurable(appliedLsn)) {
+            cout << "Operation could not be written to the log.\n";
+            return false;
+        }
+        return true;
+    }
+
+    bool logCirculation(WalOp op, const User* user, int bookId) {
+        BinaryWriter record = logRecord(op);
+        record.write(user->getUsername());
+        record.write(bookId);
+        return logOperation(record);
+    }
+
+    // State changes behind the logged operations. Callers validate and log
+    // first; these only apply, without notifications, so replay uses them
+    // directly.
+    Book* applyAddBook(unique_ptr<Book> book) {
+        book->setId(nextBookId++);
+        genrePopularity[book->getGenre()]++;
+        books.push_back(move(book));
+        catalog.add(books.back().get());
+        return books.back().get();
+    }
+
+    void applyUpdateBookStatus(Admin* admin, Book* book, BookStatus newStatus) {
+        admin->updateBookStatus(book, newStatus);
+        catalog.refresh(book);
+    }
+
+    User& applyRegisterUser(const string& username, const string& password, const string& name,
+                            const string& email, UserType type) {
+        User& user = users.emplace(username, User(username, password, name, email, type)).first->second;
+        user.setId(nextUserId++);
+        usernamesById.push_back(username);
+        return user;
+    }
+
+    // Returns the due date
+    string applyBorrow(User* user, Book* book) {
+        int dueDay = LibraryUtils::currentDay() +
+            (user->getType() == UserType::PREMIUM ? PREMIUM_BORROW_DAYS : MAX_BORROW_DAYS);
+        string dueDate = LibraryUtils::formatDay(dueDay);
+
+        book->recordBorrow(user->getUsername());
+        catalog.recordBorrow(book);
+        catalog.refresh(book);
+        user->borrowBook(book->getId(), dueDate);
+
+        size_t loan = transactions.append(
+            Transaction(nextTransactionId++, user->getId(), book->getId(), TransactionType::BORROW, 0, dueDay));
+        openLoans[makeLoanKey(user->getId(), book->getId())] = loan;
+        dueDates.schedule(loan, dueDay);
+        return dueDate;
+    }
+
+    void applyReturn(User* user, Book* book) {
+        user->returnBook(book->getId());
+        book->recordReturn(user->getUsername());
+        catalog.refresh(book);
+
+        auto loan = openLoans.find(makeLoanKey(user->getId(), book->getId()));
+        if (loan != openLoans.end()) {
+            transactions.markReturned(loan->second);
+            openLoans.erase(loan);
+        }
+    }
+
+    void applyRenew(User* user, int bookId) {
+        auto loan = openLoans.find(makeLoanKey(user->getId(), bookId));
+        if (loan == openLoans.end()) return;
+        transactions.renew(loan->second, user->getType() == UserType::PREMIUM ? PREMIUM_BORROW_DAYS : MAX_BORROW_DAYS);
+        const Transaction& borrow = transactions[loan->second];
+        user->updateDueDate(bookId, borrow.getDueDate());
+        dueDates.schedule(loan->second, borrow.getDueDay());
+        transactions.append(Transaction(nextTransactionId++, user->getId(), bookId, TransactionType::RENEW));
+    }
+
+    void applyReserve(User* user, Book* book) {
+        book->reserve(user->getUsername());
+        catalog.refresh(book);
+        user->reserveBook(book->getId());
+        transactions.append(Transaction(nextTransactionId++, user->getId(), book->getId(), TransactionType::RESERVE));
+    }
+
+    void applyCancelReservation(User* user, Book* book) {
+        book->cancelReservation(user->getUsername());
+        catalog.refresh(book);
+        user->cancelReservation(book->getId());
+    }
+
+    void applyReview(User* user, Book* book, const string& review, int rating) {
+        book->addReview(review, user->getUsername(), rating);
+        catalog.refresh(book);
+    }
+
+    void applyFavoriteGenre(User* user, const string& genre) {
+        user->addFavoriteGenre(genre);
+        genreSubscribers[StringPool::intern(LibraryUtils::toLower(genre))].push_back(user->getId());
+    }
+
+    // Appends imported books; they are indexed separately (indexImported)
+    void applyImportBatch(vector<unique_ptr<Book>>& batch, vector<Book*>& added) {
+        for (auto& book : batch) {
+            book->setId(nextBookId++);
+            genrePopularity[book->getGenre()]++;
+            added.push_back(book.get());
+            books.push_back(move(book));
+        }
+        batch.clear();
+    }
+
+    User* findUser(const string& username) {
+        auto it = users.find(username);
+        return it != users.end() ? &it->second : nullptr;
+    }
+
+    Admin* findAdmin(const string& username) {
+        for (auto& admin : admins) {
+            if (admin.getUsername() == username) return &admin;
+        }
+        return nullptr;
+    }
+
+    // Applies one logged operation with the clock set to its time. The
+    // operation was validated when it was logged, so only the state change
+    // is repeated; notifications were sent the first time.
+    void applyLogRecord(const string& payload) {
+        BinaryReader in(payload.data(), payload.size());
+        WalOp op;
+        time_t time = 0;
+        in.read(op);
+        in.read(time);
+        FakeClock clock(time);
+        Clock* previous = LibraryUtils::activeClock().load();
+        LibraryUtils::setClock(&clock);
+
+        string name, text;
+        int bookId = 0;
+        switch (op) {
+            case WalOp::ADD_BOOK: {
+                unique_ptr<Book> book = loadBook(in);
+                if (book && in.ok()) applyAddBook(move(book));
+                break;
+            }
+            case WalOp::REMOVE_BOOK:
+            case WalOp::UPDATE_BOOK_STATUS: {
+                BookStatus status = BookStatus::AVAILABLE;
+                in.read(name);
+                in.read(bookId);
+                if (op == WalOp::UPDATE_BOOK_STATUS) in.read(status);
+                Admin* admin = findAdmin(name);
+                Book* book = findBook(bookId);
+                if (!in.ok() || !admin || !book) break;
+                if (op == WalOp::REMOVE_BOOK) admin->removeBook(books, catalog, bookId);
+                else applyUpdateBookStatus(admin, book, status);
+                break;
+            }
+            case WalOp::REGISTER_USER: {
+                string password, fullName, email;
+                UserType type = UserType::STANDARD;
+                in.read(name);
+                in.read(password);
+                in.read(fullName);
+                in.read(email);
+                in.read(type);
+                if (in.ok() && !findUser(name)) applyRegisterUser(name, password, fullName, email, type);
+                break;
+            }
+            case WalOp::REVIEW: {
+                int rating = 0;
+                in.read(name);
+                in.read(bookId);
+                in.read(text);
+                in.read(rating);
+                User* user = findUser(name);
+                Book* book = findBook(bookId);
+                if (in.ok() && user && book) applyReview(user, book, text, rating);
+                break;
+            }
+            case WalOp::ADD_FAVORITE_GENRE: {
+                in.read(name);
+                in.read(text);
+                User* user = findUser(name);
+                if (in.ok() && user) applyFavoriteGenre(user, text);
+                break;
+            }
+            case WalOp::ADD_TO_BALANCE: {
+                double amount = 0;
+                in.read(name);
+                in.read(amount);
+                User* user = findUser(name);
+                if (in.ok() && user) user->addToBalance(amount);
+                break;
+            }
+            case WalOp::IMPORT_BOOKS: {
+                vector<unique_ptr<Book>> batch;
+                vector<Book*> added;
+                uint32_t count = in.readCount(1);
+                for (uint32_t i = 0; i < count && in.ok(); ++i) {
+                    unique_ptr<Book> book = loadBook(in);
+                    if (book && in.ok()) batch.push_back(move(book));
+                }
+                applyImportBatch(batch, added);
+                for (Book* book : added) catalog.add(book);
+                break;
+            }
+            default: {
+                in.read(name);
+                in.read(bookId);
+                User* user = findUser(name);
+                Book* book = findBook(bookId);
+                if (!in.ok() || !user) break;
+                if (op == WalOp::RENEW) {
+                    applyRenew(user, bookId);
+                    break;
+                }
+                if (!book) break;
+                switch (op) {
+                    case WalOp::BORROW: applyBorrow(user, book); break;
+                    case WalOp::RETURN: applyReturn(user, book); break;
+                    case WalOp::RESERVE: applyReserve(user, book); break;
+                    case WalOp::CANCEL_RESERVATION: applyCancelReservation(user, book); break;
+                    default: break;
+                }
+                break;
+            }
+        }
+        LibraryUtils::setClock(previous);
+    }
+
+    // Logs a batch of imported books as one record, then appends them.
+    // They are not indexed yet; see indexImported.
+    bool commitImportBatch(vector<unique_ptr<Book>>& batch, vector<Book*>& added) {
+        if (batch.empty()) return true;
+        BinaryWriter record = logRecord(WalOp::IMPORT_BOOKS);
+        record.write(static_cast<uint32_t>(batch.size()));
+        for (const auto& book : batch) {
+            if (!saveBook(record, *book)) {
+                cout << "Unsupported book type: " << book->getTitle() << "; batch not imported.\n";
+                batch.clear();
+                return false;
+            }
+        }
+        if (!logOperation(record)) {
+            batch.clear();
+            return false;
+        }
+        applyImportBatch(batch, added);
+        return true;
+    }
+
+    // Indexes imported books in one pass and sends each genre subscriber
+    // one notice per genre instead of one per book
+    void indexImported(const vector<Book*>& added) {
+        map<Symbol, int> newByGenre;
+        for (Book* book : added) {
+            catalog.add(book);
+            vector<Symbol> genres;
+            for (Symbol tag : book->getTags()) genres.push_back(StringPool::folded(tag));
+            sort(genres.begin(), genres.end());
+            genres.erase(unique(genres.begin(), genres.end()), genres.end());
+            for (Symbol genre : genres) newByGenre[genre]++;
+        }
+        for (const auto& entry : newByGenre) {
+            auto subscribers = genreSubscribers.find(entry.first);
+            if (subscribers == genreSubscribers.end()) continue;
+            string message = to_string(entry.second) + " new book(s) added in your favorite genre (" +
+                             StringPool::text(entry.first) + ").";
+            for (int userId : subscribers->second) {
+                dispatcher.sendNotification(usernamesById[userId], message, NotificationType::NEW_BOOK_ARRIVAL);
+            }
+        }
+    }
+
+    // Applies the logged operations newer than appliedLsn; returns the
+    // last sequence number in the log. A record that does not follow on
+    // from the current state (the log was checkpointed after a newer
+    // snapshot) stops the replay.
+    uint64_t replayLog(const string& path, uint64_t& validBytes) {
+        size_t replayed = 0;
+        bool gap = false;
+        streambuf* console = cout.rdbuf(nullptr);     // replayed operations stay quiet
+        replaying = true;
+        uint64_t lastLsn = WriteAheadLog::replay(path, [&](uint64_t lsn, const string& payload) {
+            if (lsn <= appliedLsn || gap) return;
+            if (lsn != appliedLsn + 1 && (appliedLsn > 0 || replayed > 0)) {
+                gap = true;
+                return;
+            }
+            applyLogRecord(payload);
+            appliedLsn = lsn;
+            replayed++;
+        }, validBytes);
+        replaying = false;
+        cout.rdbuf(console);
+
+        if (replayed > 0) {
+            cout << "Replayed " << replayed << " logged operations.\n";
+        }
+        if (gap) {
+            cout << "Warning: " << path << " does not continue from the loaded snapshot; "
+                 << "later records were not applied.\n";
+        }
+        return lastLsn;
+    }
+
+    static bool finishExport(ExportWriter& out, const string& path, const string& what) {
+        if (!out.finish()) {
+            cout << "Failed to write export file " << path << ".\n";
+            return false;
+        }
+        cout << "Exported " << out.recordCount() << " " << what << " to " << path << ".\n";
+        return true;
+    }
+
+    // Derived state after a bulk load: catalog, open loans, due-date
+    // events and genre subscriptions
+    void rebuildIndexes() {
+        catalog = CatalogIndex();
+        for (const auto& book : books) catalog.add(book.get());
+
+        openLoans.clear();
+        dueDates = DueDateScheduler();
+        transactions.forEachOpenLoan([&](size_t i, const Transaction& trans) {
+            openLoans[makeLoanKey(trans.getUserId(), trans.getBookId())] = i;
+            dueDates.schedule(i, trans.getDueDay());
+        });
+
+        genreSubscribers.clear();
+        for (size_t id = 1; id < usernamesById.size(); ++id) {
+            for (const auto& genre : users.at(usernamesById[id]).getFavoriteGenres()) {
+                genreSubscribers[StringPool::intern(genre)].push_back(static_cast<int>(id));
+            }
+        }
+    }
 
 public:
     Library(string name = "City Central Library", string address = "123 Library St.", 
             string established = "2000-01-01")
-        : libraryName(name), libraryAddress(address), establishedDate(established),
-          nextBookId(1), nextUserId(1), nextAdminId(1), nextTransactionId(1) {
+        : usernamesById(1), nextBookId(1), nextUserId(1), nextAdminId(1), nextTransactionId(1),
+          libraryName(name), libraryAddress(address), establishedDate(established),
+          appliedLsn(0), logBatchDepth(0), replaying(false) {
         // Initialize with default operating hours
         libraryHours = {
             "Monday: 9:00 AM - 6:00 PM",
@@ -1415,6 +5958,8 @@ public:
         admins.emplace_back("admin", "Admin@123", "full", "System Administrator", "admin@library.com");
         admins.emplace_back("librarian", "Lib@1234", "limited", "Head Librarian", "librarian@library.com");
         admins.emplace_back("support", "Support@123", "support", "Support Staff", "support@library.com");
+        
+        dispatcher.addSink(make_unique<InboxSink>(notificationSystem));
     }
 
     // Book management methods
@@ -1423,47 +5968,236 @@ public:
             cout << "Cannot add more books. Library capacity reached.\n";
             return;
         }
-        book->setId(nextBookId++);
-        genrePopularity[book->getGenre()]++;
-        books.push_back(move(book));
-        cout << "Book added with ID: " << books.back()->getId() << "\n";
-        
-        // Notify users who might be interested in this genre
-        for (auto& userPair : users) {
-            for (const auto& favGenre : userPair.second.getFavoriteGenres()) {
-                if (books.back()->hasTag(favGenre)) {
-                    notificationSystem.sendNotification(
-                        userPair.first,
-                        "New book added in your favorite genre (" + favGenre + "): " + books.back()->getTitle(),
-                        NotificationType::NEW_BOOK_ARRIVAL
-                    );
+        string isbnProblem = catalog.checkISBN(book.get());
+        if (!isbnProblem.empty()) {
+            cout << isbnProblem << "\n";
+            return;
+        }
+        BinaryWriter record = logRecord(WalOp::ADD_BOOK);
+        if (!saveBook(record, *book)) {
+            cout << "Unsupported book type; the book cannot be stored.\n";
+            return;
+        }
+        if (!logOperation(record)) return;
+        Book* added = applyAddBook(move(book));
+        cout << "Book added with ID: " << added->getId() << "\n";
+
+        // Notify users who follow one of the book's tags
+        vector<Symbol> genres;
+        for (Symbol tag : added->getTags()) genres.push_back(StringPool::folded(tag));
+        sort(genres.begin(), genres.end());
+        genres.erase(unique(genres.begin(), genres.end()), genres.end());
+        for (Symbol genre : genres) {
+            auto subscribers = genreSubscribers.find(genre);
+            if (subscribers == genreSubscribers.end()) continue;
+            string message = "New book added in your favorite genre (" + StringPool::text(genre) + 
+                             "): " + added->getTitle();
+            for (int userId : subscribers->second) {
+                dispatcher.sendNotification(usernamesById[userId], message, 
+                                            NotificationType::NEW_BOOK_ARRIVAL);
+            }
+        }
+    }
+
+    // Bulk-loads books from a CSV file (columns: see CatalogImporter).
+    // Each chunk of rows is committed with a single log record, and the
+    // new books are indexed once at the end. Returns the number imported.
+    size_t importBooks(Admin* admin, const string& path) {
+        if (!admin) {
+            cout << "Invalid admin account.\n";
+            return 0;
+        }
+        if (!admin->hasFullAccess() && !admin->hasLimitedAccess()) {
+            cout << "You don't have permission to import books.\n";
+            return 0;
+        }
+        CatalogImporter importer(path);
+        if (!importer.open()) return 0;
+
+        vector<ImportRow> rows;
+        vector<unique_ptr<Book>> batch;
+        vector<Book*> added;
+        unordered_set<uint64_t> importedIsbns;
+        size_t rejected = 0;
+        bool full = false;
+        auto reject = [&](size_t row, const string& problem) {
+            if (rejected++ < IMPORT_MAX_REPORTED_ERRORS) cout << "Row " << row << ": " << problem << "\n";
+        };
+
+        beginLogBatch();
+        while (!full && importer.nextBatch(rows)) {
+            for (const auto& row : rows) {
+                if (!row.error.empty()) {
+                    reject(row.number, row.error);
+                    continue;
+                }
+                if (books.size() + batch.size() >= MAX_BOOKS_IN_LIBRARY) {
+                    cout << "Library capacity reached; import stopped at row " << row.number << ".\n";
+                    full = true;
+                    break;
+                }
+                unique_ptr<Book> book;
+                try {
+                    book = CatalogImporter::build(row);
+                } catch (const invalid_argument& e) {
+                    reject(row.number, e.what());
+                    continue;
                 }
+                string isbnProblem = catalog.checkISBN(book.get());
+                uint64_t isbnKey = 0;
+                LibraryUtils::normalizeISBN(book->getISBN(), isbnKey);
+                if (isbnProblem.empty() && !importedIsbns.insert(isbnKey).second) {
+                    isbnProblem = "ISBN " + book->getISBN() + " appears earlier in the file.";
+                }
+                if (!isbnProblem.empty()) {
+                    reject(row.number, isbnProblem);
+                    continue;
+                }
+                batch.push_back(move(book));
             }
+            if (!commitImportBatch(batch, added)) break;
+        }
+        commitLogBatch();
+        indexImported(added);
+
+        if (rejected > IMPORT_MAX_REPORTED_ERRORS) {
+            cout << "(" << rejected - IMPORT_MAX_REPORTED_ERRORS << " more rejected rows not shown)\n";
         }
+        cout << "Imported " << added.size() << " books from " << path << "; " << rejected << " rows rejected.\n";
+        return added.size();
     }
 
-    Book* findBook(int bookId) {
-        auto it = find_if(books.begin(), books.end(), 
-            [bookId](const unique_ptr<Book>& b) { return b->getId() == bookId; });
-        return it != books.end() ? it->get() : nullptr;
+    // Subscribes the user to new-arrival notices for the genre
+    bool addFavoriteGenre(User* user, const string& genre) {
+        if (!user || !user->getIsActive()) {
+            cout << "Invalid or inactive user account.\n";
+            return false;
+        }
+        const vector<string>& favorites = user->getFavoriteGenres();
+        if (find(favorites.begin(), favorites.end(), LibraryUtils::toLower(genre)) != favorites.end()) {
+            return false;
+        }
+
+        BinaryWriter record = logRecord(WalOp::ADD_FAVORITE_GENRE);
+        record.write(user->getUsername());
+        record.write(genre);
+        if (!logOperation(record)) return false;
+        applyFavoriteGenre(user, genre);
+        return true;
+    }
+
+    Book* findBook(int bookId) const {
+        return catalog.findById(bookId);
+    }
+
+    // Every book by an author, including co-authored textbooks
+    vector<Book*> findBooksByAuthor(const string& author) const {
+        return catalog.findByAuthor(author);
+    }
+
+    // Books of a series in series-number order
+    vector<Book*> findSeries(const string& seriesName) const {
+        return catalog.findSeries(seriesName);
+    }
+
+    // Textbooks assigned to a course, e.g. "CS101"
+    vector<Book*> findBooksForCourse(const string& courseCode) const {
+        return catalog.findByCourse(courseCode);
+    }
+
+    // Barcode lookup; accepts ISBN-10 or ISBN-13, with or without hyphens
+    Book* findBookByISBN(const string& isbn) const {
+        return catalog.findByISBN(isbn);
+    }
+
+    void removeBook(Admin* admin, int bookId) {
+        if (!admin) {
+            cout << "Invalid admin account.\n";
+            return;
+        }
+        if (!admin->hasFullAccess() && !admin->hasLimitedAccess()) {
+            cout << "You don't have permission to remove books.\n";
+            return;
+        }
+        if (!findBook(bookId)) {
+            cout << "Book ID " << bookId << " not found.\n";
+            return;
+        }
+        BinaryWriter record = logRecord(WalOp::REMOVE_BOOK);
+        record.write(admin->getUsername());
+        record.write(bookId);
+        if (!logOperation(record)) return;
+        admin->removeBook(books, catalog, bookId);
+    }
+
+    void displaySystemStats(const Admin* admin) const {
+        if (!admin) {
+            cout << "Invalid admin account.\n";
+            return;
+        }
+        admin->displaySystemStats(catalog, users);
     }
 
     vector<Book*> searchBooks(const string& query) {
-        vector<Book*> results;
-        string lowerQuery = LibraryUtils::toLower(query);
-        
-        for (const auto& book : books) {
-            if (LibraryUtils::toLower(book->getTitle()).find(lowerQuery) != string::npos ||
-                LibraryUtils::toLower(book->getAuthor()).find(lowerQuery) != string::npos ||
-                LibraryUtils::toLower(book->getDescription()).find(lowerQuery) != string::npos ||
-                book->hasTag(query)) {
-                results.push_back(book.get());
-            }
+        if (LibraryUtils::tokenize(query).empty()) {
+            vector<Book*> results;
+            for (const auto& book : books) results.push_back(book.get());
+            return results;
+        }
+        vector<Book*> results = catalog.search(query);
+        if (results.empty()) {
+            // Nothing matched exactly; the query may be misspelled
+            results = catalog.searchFuzzy(query, MAX_FUZZY_RESULTS);
         }
-        
         return results;
     }
 
+    // Faceted filtering, e.g. available AND EPUB AND English AND year > 2015,
+    // with per-value counts for the matching books
+    FacetResult filterBooks(const FacetQuery& query) const {
+        return catalog.filter(query);
+    }
+
+    // Search-as-you-type: most borrowed titles, authors and series for a prefix
+    vector<string> autocomplete(const string& prefix, size_t limit = AUTOCOMPLETE_TOP_N) const {
+        return catalog.autocomplete(prefix, limit);
+    }
+
+    // Title/author matches tolerant of typos, closest first
+    vector<Book*> searchBooksFuzzy(const string& query, size_t limit = 10) const {
+        return catalog.searchFuzzy(query, limit);
+    }
+
+    // Most relevant books first, at most topK of them
+    vector<Book*> searchBooksRanked(const string& query, size_t topK = 10) const {
+        return catalog.searchRanked(query, topK);
+    }
+
+    void updateBookStatus(Admin* admin, int bookId, BookStatus newStatus) {
+        Book* book = findBook(bookId);
+        if (!admin || !book) {
+            cout << "Invalid admin account or book ID.\n";
+            return;
+        }
+        if (!admin->hasFullAccess() && !admin->hasLimitedAccess()) {
+            cout << "You don't have permission to update book status.\n";
+            return;
+        }
+        BinaryWriter record = logRecord(WalOp::UPDATE_BOOK_STATUS);
+        record.write(admin->getUsername());
+        record.write(bookId);
+        record.write(newStatus);
+        if (!logOperation(record)) return;
+        applyUpdateBookStatus(admin, book, newStatus);
+    }
+
+    void reindexBook(int bookId) {
+        Book* book = findBook(bookId);
+        if (book) {
+            catalog.reindex(book);
+        }
+    }
+
     void displayAllBooks(bool detailed = false) const {
         if (books.empty()) {
             cout << "No books in the library.\n";
@@ -1492,15 +6226,7 @@ public:
     }
 
     void displayBooksByGenre(const string& genre) const {
-        string lowerGenre = LibraryUtils::toLower(genre);
-        vector<const Book*> genreBooks;
-        
-        for (const auto& book : books) {
-            if (LibraryUtils::toLower(book->getGenre()) == lowerGenre || 
-                book->hasTag(genre)) {
-                genreBooks.push_back(book.get());
-            }
-        }
+        vector<Book*> genreBooks = catalog.findByGenre(genre);
         
         if (genreBooks.empty()) {
             cout << "No books found in genre: " << genre << "\n";
@@ -1534,8 +6260,16 @@ public:
             cout << "Invalid email format.\n";
             return false;
         }
-        users.emplace(username, User(username, password, name, email, type));
-        cout << "User registered successfully with ID: " << nextUserId++ << "\n";
+        BinaryWriter record = logRecord(WalOp::REGISTER_USER);
+        record.write(username);
+        record.write(password);
+        record.write(name);
+        record.write(email);
+        record.write(type);
+        if (!logOperation(record)) return false;
+
+        User& user = applyRegisterUser(username, password, name, email, type);
+        cout << "User registered successfully with ID: " << user.getId() << "\n";
         return true;
     }
 
@@ -1597,15 +6331,8 @@ public:
             return false;
         }
 
-        // Calculate due date based on user type
-        string dueDate = LibraryUtils::getCurrentDate(); // Should calculate actual due date
-        
-        book->recordBorrow(user->getUsername());
-        user->borrowBook(bookId, dueDate);
-        
-        // Record transaction
-        transactions.emplace_back(nextTransactionId++, user->getUsername(), bookId, "borrow");
-        
+        if (!logCirculation(WalOp::BORROW, user, bookId)) return false;
+        string dueDate = applyBorrow(user, book);
         cout << "Book \"" << book->getTitle() << "\" borrowed successfully. Due date: " << dueDate << "\n";
         return true;
     }
@@ -1622,25 +6349,19 @@ public:
             return false;
         }
         
-        if (!user->returnBook(bookId)) {
+        const vector<int>& borrowed = user->getBorrowedBooks();
+        if (find(borrowed.begin(), borrowed.end(), bookId) == borrowed.end()) {
+            cout << "Book not found in your borrowed list.\n";
             return false;
         }
-        
-        book->recordReturn(user->getUsername());
-        
-        // Find and update transaction
-        for (auto& trans : transactions) {
-            if (trans.getBookId() == bookId && trans.getUsername() == user->getUsername() && !trans.getIsReturned()) {
-                trans.markReturned();
-                break;
-            }
-        }
-        
+
+        if (!logCirculation(WalOp::RETURN, user, bookId)) return false;
+        applyReturn(user, book);
         cout << "Book \"" << book->getTitle() << "\" returned successfully.\n";
         
         // Check if there are reservations for this book
         if (book->getStatus() == BookStatus::AVAILABLE && book->hasReservations()) {
-            notificationSystem.sendNotification(
+            dispatcher.sendNotification(
                 book->getNextReservedUser(),
                 "The book you reserved (ID: " + to_string(bookId) + ") is now available.",
                 NotificationType::RESERVATION_AVAILABLE
@@ -1650,6 +6371,38 @@ public:
         return true;
     }
 
+    bool renewBook(User* user, int bookId) {
+        if (!user || !user->getIsActive()) {
+            cout << "Invalid or inactive user account.\n";
+            return false;
+        }
+        
+        auto loan = openLoans.find(makeLoanKey(user->getId(), bookId));
+        if (loan == openLoans.end()) {
+            cout << "No open loan found for this book.\n";
+            return false;
+        }
+
+        const Transaction& borrow = transactions[loan->second];
+        if (borrow.getRenewals() >= MAX_RENEWALS) {
+            cout << "This loan has already been renewed " << MAX_RENEWALS << " times.\n";
+            return false;
+        }
+        if (borrow.getDueDay() < LibraryUtils::currentDay()) {
+            cout << "This loan is overdue. Please return the book instead.\n";
+            return false;
+        }
+        Book* book = findBook(bookId);
+        if (book && book->isReservedByOthers(user->getUsername())) {
+            cout << "Another user has reserved this book, so it cannot be renewed.\n";
+            return false;
+        }
+        
+        if (!logCirculation(WalOp::RENEW, user, bookId)) return false;
+        applyRenew(user, bookId);
+        return true;
+    }
+
     bool reserveBook(User* user, int bookId) {
         if (!user || !user->getIsActive()) {
             cout << "Invalid or inactive user account.\n";
@@ -1662,15 +6415,19 @@ public:
             return false;
         }
         
-        if (!book->reserve(user->getUsername())) {
+        if (book->getStatus() != BookStatus::AVAILABLE) {
+            cout << "Book is not available for reservation.\n";
             return false;
         }
-        
-        user->reserveBook(bookId);
-        
-        // Record transaction
-        transactions.emplace_back(nextTransactionId++, user->getUsername(), bookId, "reserve");
-        
+        const vector<int>& reserved = user->getReservedBooks();
+        if (book->isReservedBy(user->getUsername()) ||
+            find(reserved.begin(), reserved.end(), bookId) != reserved.end()) {
+            cout << "You've already reserved this book.\n";
+            return false;
+        }
+
+        if (!logCirculation(WalOp::RESERVE, user, bookId)) return false;
+        applyReserve(user, book);
         cout << "Book \"" << book->getTitle() << "\" reserved successfully.\n";
         return true;
     }
@@ -1687,13 +6444,55 @@ public:
             return false;
         }
         
-        if (!book->cancelReservation(user->getUsername())) {
+        if (!book->isReservedBy(user->getUsername())) {
+            cout << "No reservation found for this user.\n";
             return false;
         }
-        
-        user->cancelReservation(bookId);
-        cout << "Reservation for book \"" << book->getTitle() << "\" cancelled.\n";
-        return true;
+
+        if (!logCirculation(WalOp::CANCEL_RESERVATION, user, bookId)) return false;
+        applyCancelReservation(user, book);
+        cout << "Reservation for book \"" << book->getTitle() << "\" cancelled.\n";
+        return true;
+    }
+
+    void reviewBook(User* user, int bookId, const string& review, int rating) {
+        if (!user || !user->getIsActive()) {
+            cout << "Invalid or inactive user account.\n";
+            return;
+        }
+        Book* book = findBook(bookId);
+        if (!book) {
+            cout << "Book not found.\n";
+            return;
+        }
+        if (review.length() > MAX_REVIEW_LENGTH) {
+            cout << "Review exceeds maximum length of " << MAX_REVIEW_LENGTH << " characters.\n";
+            return;
+        }
+        if (rating < 1 || rating > 5) {
+            cout << "Rating must be between 1 and 5.\n";
+            return;
+        }
+        BinaryWriter record = logRecord(WalOp::REVIEW);
+        record.write(user->getUsername());
+        record.write(bookId);
+        record.write(review);
+        record.write(rating);
+        if (!logOperation(record)) return;
+        applyReview(user, book, review, rating);
+    }
+
+    // Charges (positive) or credits (negative) a user's account
+    void addToBalance(User* user, double amount) {
+        if (!user) {
+            cout << "Invalid user account.\n";
+            return;
+        }
+        BinaryWriter record = logRecord(WalOp::ADD_TO_BALANCE);
+        record.write(user->getUsername());
+        record.write(amount);
+        if (!logOperation(record)) return;
+        user->addToBalance(amount);
     }
 
     void displayBorrowStats() const {
@@ -1702,17 +6501,7 @@ public:
             return;
         }
         
-        // Convert to vector for sorting
-        map<int, int> borrowCounts;
-        for (const auto& book : books) {
-            borrowCounts[book->getId()] = book->getBorrowCount();
-        }
-        
-        vector<pair<int, int>> stats(borrowCounts.begin(), borrowCounts.end());
-        sort(stats.begin(), stats.end(), 
-            [](const pair<int, int>& a, const pair<int, int>& b) {
-                return a.second > b.second;
-            });
+        vector<pair<int, int>> stats = catalog.getColumns().mostBorrowed(10);
         
         cout << "\nMost Borrowed Books (Top 10):\n";
         cout << "========================================\n";
@@ -1727,18 +6516,17 @@ public:
     }
 
     void displayOverdueBooks() const {
-        string today = LibraryUtils::getCurrentDate();
-        vector<const Transaction*> overdueTransactions;
-        
-        for (const auto& trans : transactions) {
-            if (trans.getType() == "borrow" && !trans.getIsReturned()) {
-                int daysOverdue = LibraryUtils::daysBetweenDates(trans.getDueDate(), today);
-                if (daysOverdue > 0) {
-                    overdueTransactions.push_back(&trans);
-                }
+        int today = LibraryUtils::currentDay();
+        vector<size_t> overdueLoans;
+        for (const auto& loan : openLoans) {
+            if (transactions[loan.second].getDueDay() < today) {
+                overdueLoans.push_back(loan.second);
             }
         }
-        
+        sort(overdueLoans.begin(), overdueLoans.end());    // oldest first
+        vector<const Transaction*> overdueTransactions;
+        for (size_t loan : overdueLoans) overdueTransactions.push_back(&transactions[loan]);
+
         if (overdueTransactions.empty()) {
             cout << "No overdue books currently.\n";
             return;
@@ -1748,9 +6536,9 @@ public:
         cout << "========================================\n";
         for (const auto& trans : overdueTransactions) {
             Book* book = findBook(trans->getBookId());
-            int daysOverdue = LibraryUtils::daysBetweenDates(trans->getDueDate(), today);
+            int daysOverdue = today - trans->getDueDay();
             
-            cout << "User: " << trans->getUsername() << "\n";
+            cout << "User: " << usernamesById[trans->getUserId()] << "\n";
             cout << "Book: " << (book ? book->getTitle() : "Unknown") << " (ID: " << trans->getBookId() << ")\n";
             cout << "Due Date: " << trans->getDueDate() << " (Overdue by " << daysOverdue << " days)\n";
             cout << "Late Fee: $" << fixed << setprecision(2) << daysOverdue * LATE_FEE_PER_DAY << "\n";
@@ -1758,6 +6546,57 @@ public:
         }
     }
 
+    // Circulation history of one book, oldest first
+    void displayBookHistory(int bookId) const {
+        vector<const Transaction*> history;
+        transactions.forEachForBook(bookId, [&](const Transaction& trans) {
+            history.push_back(&trans);
+        });
+        
+        if (history.empty()) {
+            cout << "No transactions found for book ID " << bookId << ".\n";
+            return;
+        }
+        
+        cout << "\nHistory of book ID " << bookId << " (" << history.size() << " transactions):\n";
+        cout << "========================================\n";
+        for (const auto& trans : history) {
+            trans->displayInfo(usernamesById[trans->getUserId()]);
+        }
+    }
+
+    // Counts and late fees for transactions dated between two YYYY-MM-DD dates
+    void displayCirculationReport(const string& fromDate, const string& toDate) const {
+        int fromDay, toDay;
+        if (!LibraryUtils::parseDay(fromDate, fromDay) || !LibraryUtils::parseDay(toDate, toDay)) {
+            cout << "Invalid date range. Use YYYY-MM-DD.\n";
+            return;
+        }
+        
+        map<TransactionType, int> typeCounts;
+        int returned = 0;
+        double lateFees = 0.0;
+        transactions.forEachInRange(fromDay, toDay, [&](const Transaction& trans) {
+            typeCounts[trans.getType()]++;
+            if (trans.getIsReturned()) {
+                returned++;
+                lateFees += trans.getLateFee();
+            }
+        });
+        
+        cout << "\nCirculation Report " << fromDate << " to " << toDate << ":\n";
+        cout << "========================================\n";
+        if (typeCounts.empty()) {
+            cout << "No transactions in this period.\n";
+            return;
+        }
+        for (const auto& entry : typeCounts) {
+            cout << Transaction::typeName(entry.first) << ": " << entry.second << "\n";
+        }
+        cout << "Returned loans: " << returned << "\n";
+        cout << "Late fees: $" << fixed << setprecision(2) << lateFees << "\n";
+    }
+
     void displayLibraryInfo() const {
         cout << "\nLibrary Information:\n";
         cout << "========================================\n";
@@ -1774,8 +6613,9 @@ public:
         cout << "========================================\n";
     }
 
+    // Daily job: due-tomorrow reminders and overdue notices
     void checkDueDates() {
-        notificationSystem.checkDueDates(transactions);
+        dueDates.process(LibraryUtils::currentDay(), transactions, usernamesById, dispatcher);
     }
 
     void displayPopularGenres() const {
@@ -1801,15 +6641,440 @@ public:
     void sendNotificationToUser(const string& username, const string& message, 
                               NotificationType type) {
         if (users.find(username) != users.end()) {
-            notificationSystem.sendNotification(username, message, type);
+            dispatcher.sendNotification(username, message, type);
             cout << "Notification sent to " << username << ".\n";
         } else {
             cout << "User not found.\n";
         }
     }
 
-    void displayUserNotifications(const string& username) const {
+    // Applies the notification retention policy; meant for a periodic job
+    void pruneNotifications() {
+        dispatcher.flush();
+        size_t removed = notificationSystem.applyRetention();
+        if (removed > 0) {
+            cout << "Removed " << removed << " expired notifications.\n";
+            dispatcher.requestMaintenance();
+        }
+    }
+
+    void setNotificationRetention(Admin* admin, const NotificationRetention& policy) {
+        if (!admin) {
+            cout << "Invalid admin account.\n";
+            return;
+        }
+        notificationSystem.setRetention(policy);
+        pruneNotifications();
+    }
+
+    void displayNotificationStats(const Admin* admin) const {
+        if (!admin) {
+            cout << "Invalid admin account.\n";
+            return;
+        }
+        dispatcher.flush();
+        NotificationStats stats = notificationSystem.getStats();
+        cout << "\nNotification Store:\n";
+        cout << "========================================\n";
+        cout << "Live notifications: " << stats.liveNotifications << "\n";
+        cout << "Store slots: " << stats.storeSlots << "\n";
+        cout << "Recipients: " << stats.recipients << "\n";
+        cout << "Approx. memory: " << stats.approxBytes / 1024 << " KB (high-water "
+             << stats.highWaterBytes / 1024 << " KB)\n";
+        cout << "Removed by retention: " << stats.totalRemoved << "\n";
+        cout << "Compactions: " << stats.compactions << "\n";
+    }
+
+    // Writes books, users, admins, transactions and notifications to one
+    // checksummed file. The file is written beside the old one, synced,
+    // renamed over it and the directory synced; only then is the
+    // write-ahead log emptied, so a crash at any point leaves either the
+    // old snapshot with its log or the new snapshot on disk.
+    bool saveSnapshot(const string& path) {
+        dispatcher.flush();
+        string tempPath = path + ".tmp";
+        BinaryWriter out(tempPath);
+        if (!out.ok()) {
+            cout << "Cannot write snapshot " << tempPath << ".\n";
+            return false;
+        }
+        out.writeBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        out.write(SNAPSHOT_VERSION);
+        out.write(appliedLsn);
+
+        uint32_t poolSize = static_cast<uint32_t>(StringPool::size());
+        out.write(poolSize);
+        for (Symbol id = 0; id < poolSize; ++id) out.write(StringPool::text(id));
+
+        out.write(libraryName);
+        out.write(libraryAddress);
+        out.write(establishedDate);
+        out.write(libraryHours);
+        out.write(genrePopularity);
+        out.write(nextBookId);
+        out.write(nextUserId);
+        out.write(nextAdminId);
+        out.write(nextTransactionId);
+
+        out.write(static_cast<uint32_t>(books.size()));
+        for (const auto& book : books) {
+            if (!saveBook(out, *book)) {
+                cout << "Cannot snapshot book ID " << book->getId() << ": unsupported book type.\n";
+                return false;
+            }
+        }
+        out.write(static_cast<uint32_t>(usernamesById.size() - 1));
+        for (size_t id = 1; id < usernamesById.size(); ++id) users.at(usernamesById[id]).save(out);
+        out.write(static_cast<uint32_t>(admins.size()));
+        for (const auto& admin : admins) admin.save(out);
+        transactions.save(out);
+        notificationSystem.save(out);
+
+        if (!out.finish() || !LibraryUtils::syncFile(tempPath)) {
+            cout << "Failed to write snapshot " << tempPath << ".\n";
+            return false;
+        }
+#ifdef _WIN32
+        remove(path.c_str());
+#endif
+        if (rename(tempPath.c_str(), path.c_str()) != 0) {
+            cout << "Failed to replace snapshot " << path << ".\n";
+            return false;
+        }
+        if (!LibraryUtils::syncParentDirectory(path)) {
+            cout << "Warning: snapshot rename could not be synced; keeping the write-ahead log.\n";
+            return false;
+        }
+        if (wal.isOpen() && !wal.checkpoint()) {
+            cout << "Warning: write-ahead log could not be truncated.\n";
+        }
+        cout << "Snapshot saved: " << books.size() << " books, " << users.size() << " users, "
+             << transactions.size() << " transactions.\n";
+        return true;
+    }
+
+    // Replaces the current state with a snapshot. Nothing changes unless
+    // the whole file reads back with a matching checksum.
+    bool loadSnapshot(const string& path) {
+        BinaryReader in(path);
+        if (!in.ok()) {
+            cout << "Cannot open snapshot " << path << ".\n";
+            return false;
+        }
+        char magic[sizeof(SNAPSHOT_MAGIC)];
+        uint32_t version = 0;
+        uint64_t snapshotLsn = 0;
+        in.readBytes(magic, sizeof(magic));
+        in.read(version);
+        if (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 || version < 2 || version > SNAPSHOT_VERSION) {
+            cout << "Unsupported snapshot format in " << path << ".\n";
+            return false;
+        }
+        in.read(snapshotLsn);
+        in.readSymbolTable();
+
+        string name, address, established;
+        vector<string> hours;
+        map<string, int> popularity;
+        int bookIdCounter = 1, userIdCounter = 1, adminIdCounter = 1, transactionIdCounter = 1;
+        in.read(name);
+        in.read(address);
+        in.read(established);
+        in.read(hours);
+        in.read(popularity);
+        in.read(bookIdCounter);
+        in.read(userIdCounter);
+        in.read(adminIdCounter);
+        in.read(transactionIdCounter);
+
+        vector<unique_ptr<Book>> loadedBooks;
+        uint32_t bookCount = in.readCount(1);
+        loadedBooks.reserve(bookCount);
+        for (uint32_t i = 0; i < bookCount && in.ok(); ++i) {
+            unique_ptr<Book> book = loadBook(in);
+            if (book) loadedBooks.push_back(move(book));
+        }
+
+        unordered_map<string, User> loadedUsers;
+        vector<string> loadedNames(1);
+        uint32_t userCount = in.readCount(1);
+        for (uint32_t i = 0; i < userCount && in.ok(); ++i) {
+            User user(in);
+            if (user.getId() != static_cast<int>(loadedNames.size())) in.fail();
+            loadedNames.push_back(user.getUsername());
+            loadedUsers.emplace(user.getUsername(), move(user));
+        }
+
+        vector<Admin> loadedAdmins;
+        uint32_t adminCount = in.readCount(1);
+        for (uint32_t i = 0; i < adminCount && in.ok(); ++i) loadedAdmins.emplace_back(in);
+
+        TransactionLog loadedTransactions;
+        loadedTransactions.load(in, version);
+        NotificationSystem loadedNotifications;
+        loadedNotifications.load(in);
+
+        if (!in.finish()) {
+            cout << "Snapshot " << path << " is corrupt or truncated; nothing was loaded.\n";
+            return false;
+        }
+
+        dispatcher.flush();
+        libraryName = name;
+        libraryAddress = address;
+        establishedDate = established;
+        libraryHours = hours;
+        genrePopularity = popularity;
+        nextBookId = bookIdCounter;
+        nextUserId = userIdCounter;
+        nextAdminId = adminIdCounter;
+        nextTransactionId = transactionIdCounter;
+        appliedLsn = snapshotLsn;
+        books = move(loadedBooks);
+        users = move(loadedUsers);
+        usernamesById = move(loadedNames);
+        admins = move(loadedAdmins);
+        transactions = move(loadedTransactions);
+        notificationSystem.swap(loadedNotifications);
+        rebuildIndexes();
+
+        cout << "Snapshot loaded: " << books.size() << " books, " << users.size() << " users, "
+             << transactions.size() << " transactions.\n";
+        return true;
+    }
+
+    // Streams the catalog to a JSON Lines or CSV file. The CSV columns are
+    // the ones importBooks reads, type-specific ones included, so an export
+    // can be imported elsewhere; columns a book's type lacks are left empty.
+    bool exportCatalog(const string& path, ExportFormat format) const {
+        ExportWriter out(path, format, {"id", "type", "title", "author", "isbn", "publication_date",
+                                        "publisher", "language", "description", "location", "edition",
+                                        "year", "tags", "format",
+                                        "file_size_mb", "word_count", "drm", "download_link",
+                                        "pages", "binding", "dimensions", "weight", "illustrated", "condition",
+                                        "subgenre", "magic_system", "world", "series_name", "series_number",
+                                        "subject", "field", "classification", "edition_year", "exercises",
+                                        "course_code", "genre", "status", "borrow_count", "rating",
+                                        "rating_count"});
+        if (!out.ok()) {
+            cout << "Cannot write export file " << path << ".\n";
+            return false;
+        }
+        vector<string> tags;
+        for (const auto& book : books) {
+            const EBook* ebook = dynamic_cast<const EBook*>(book.get());
+            const PrintedBook* printed = dynamic_cast<const PrintedBook*>(book.get());
+            const FictionBook* fiction = dynamic_cast<const FictionBook*>(book.get());
+            const FantasyNovel* fantasy = dynamic_cast<const FantasyNovel*>(book.get());
+            const NonFictionBook* nonFiction = dynamic_cast<const NonFictionBook*>(book.get());
+            const ScienceTextbook* textbook = dynamic_cast<const ScienceTextbook*>(book.get());
+            bool series = fiction && fiction->getIsSeries();
+            tags.clear();
+            for (Symbol tag : book->getTags()) tags.push_back(StringPool::text(tag));
+
+            out.field(book->getId());
+            out.field(exportBookType(*book));
+            out.field(book->getTitle());
+            out.field(book->getAuthor());
+            out.field(book->getISBN());
+            out.field(book->getPublicationDate());
+            out.field(book->getPublisher());
+            out.field(book->getLanguage());
+            out.field(book->getDescription());
+            out.field(book->getLocation());
+            out.field(book->getEdition());
+            out.field(book->getYear());
+            out.field(tags);
+            out.field(exportName(book->getFormat()));
+
+            if (ebook) {
+                out.field(ebook->getFileSizeMB());
+                out.field(ebook->getWordCount());
+                out.field(ebook->getDrmProtected());
+                out.field(ebook->getDownloadLink());
+            } else {
+                out.nullField();
+                out.nullField();
+                out.nullField();
+                out.field("");
+            }
+
+            if (printed) {
+                out.field(printed->getPages());
+                out.field(printed->getBindingType());
+                out.field(printed->getDimensions());
+                out.field(printed->getWeight());
+                out.field(printed->getHasIllustrations());
+                out.field(printed->getCondition());
+            } else {
+                out.nullField();
+                out.field("");
+                out.field("");
+                out.nullField();
+                out.nullField();
+                out.field("");
+            }
+
+            out.field(fiction ? fiction->getSubgenre() : "");
+            if (fantasy) out.field(fantasy->getHasMagicSystem());
+            else out.nullField();
+            out.field(fantasy ? fantasy->getWorldName() : "");
+            out.field(series ? fiction->getSeriesName() : "");
+            if (series) out.field(fiction->getSeriesNumber());
+            else out.nullField();
+
+            out.field(nonFiction ? nonFiction->getSubject() : "");
+            out.field(textbook ? textbook->getField() : "");
+            out.field(nonFiction ? nonFiction->getClassification() : "");
+            if (textbook) {
+                out.field(textbook->getEditionYear());
+                out.field(textbook->getHasExercises());
+            } else {
+                out.nullField();
+                out.nullField();
+            }
+            out.field(textbook ? textbook->getCourseCode() : "");
+
+            out.field(book->getGenre());
+            out.field(exportName(book->getStatus()));
+            out.field(book->getBorrowCount());
+            out.field(book->getRating());
+            out.field(book->getRatingCount());
+            out.endRecord();
+        }
+        return finishExport(out, path, "books");
+    }
+
+    // Streams user accounts, in id order. Passwords are not exported.
+    bool exportUsers(const string& path, ExportFormat format) const {
+        ExportWriter out(path, format, {"id", "username", "full_name", "email", "type", "active",
+                                        "join_date", "last_login", "balance", "total_borrowed",
+                                        "borrowed_books", "reserved_books", "favorite_genres"});
+        if (!out.ok()) {
+            cout << "Cannot write export file " << path << ".\n";
+            return false;
+        }
+        for (size_t id = 1; id < usernamesById.size(); ++id) {
+            const User& user = users.at(usernamesById[id]);
+            out.field(user.getId());
+            out.field(user.getUsername());
+            out.field(user.getFullName());
+            out.field(user.getEmail());
+            out.field(exportName(user.getType()));
+            out.field(user.getIsActive());
+            out.field(user.getJoinDate());
+            out.field(user.getLastLogin());
+            out.field(user.getBalance());
+            out.field(user.getTotalBooksBorrowed());
+            out.field(user.getBorrowedBooks());
+            out.field(user.getReservedBooks());
+            out.field(user.getFavoriteGenres());
+            out.endRecord();
+        }
+        return finishExport(out, path, "users");
+    }
+
+    // Streams the transaction history in log order
+    bool exportTransactions(const string& path, ExportFormat format) const {
+        ExportWriter out(path, format, {"id", "type", "user_id", "username", "book_id", "time",
+                                        "due_date", "returned", "return_time", "late_fee"});
+        if (!out.ok()) {
+            cout << "Cannot write export file " << path << ".\n";
+            return false;
+        }
+        static const string unknownUser;
+        for (size_t i = 0; i < transactions.size(); ++i) {
+            const Transaction& trans = transactions[i];
+            int userId = trans.getUserId();
+            bool borrow = trans.getType() == TransactionType::BORROW;
+            out.field(trans.getId());
+            out.field(Transaction::typeName(trans.getType()));
+            out.field(userId);
+            out.field(userId > 0 && static_cast<size_t>(userId) < usernamesById.size()
+                          ? usernamesById[userId] : unknownUser);
+            out.field(trans.getBookId());
+            out.field(LibraryUtils::formatTimestamp(trans.getTransactionTime()));
+            out.field(borrow ? trans.getDueDate() : "");
+            out.field(trans.getIsReturned());
+            out.field(trans.getIsReturned() ? LibraryUtils::formatTimestamp(trans.getReturnTime()) : "");
+            out.field(trans.getLateFee());
+            out.endRecord();
+        }
+        return finishExport(out, path, "transactions");
+    }
+
+    // Writes <prefix>books, <prefix>users and <prefix>transactions with the
+    // format's extension
+    bool exportAll(const string& prefix, ExportFormat format) const {
+        string extension = format == ExportFormat::CSV ? ".csv" : ".jsonl";
+        bool catalogOk = exportCatalog(prefix + "books" + extension, format);
+        bool usersOk = exportUsers(prefix + "users" + extension, format);
+        bool transactionsOk = exportTransactions(prefix + "transactions" + extension, format);
+        return catalogOk && usersOk && transactionsOk;
+    }
+
+    // Compiles the catalog into a read-only image for kiosk processes
+    bool saveCatalogImage(const string& path) const {
+        if (!CatalogImage::build(path, books)) return false;
+        cout << "Catalog image written: " << books.size() << " books.\n";
+        return true;
+    }
+
+    // Replays the write-ahead log on top of the current state (normally
+    // just loaded from a snapshot), then keeps logging to it. Records the
+    // snapshot already covers are skipped.
+    bool openLog(const string& path) {
+        uint64_t validBytes = 0;
+        uint64_t lastLsn = replayLog(path, validBytes);
+        return wal.open(path, validBytes, max(lastLsn, appliedLsn));
+    }
+
+    // Catches up from a log another process is appending to, without
+    // opening it for writing. Stops at the last complete record.
+    void followLog(const string& path) {
+        uint64_t validBytes = 0;
+        replayLog(path, validBytes);
+    }
+
+    // Group commit tuning; see WriteAheadLog::setGroupCommit
+    void setLogGroupCommit(size_t maxRecords, int delayMicros) {
+        wal.setGroupCommit(maxRecords, delayMicros);
+    }
+
+    // Operations between beginLogBatch and commitLogBatch are logged
+    // without waiting for the disk; commitLogBatch waits once for all of
+    // them, so the flusher syncs them together. Batches nest.
+    void beginLogBatch() {
+        logBatchDepth++;
+    }
+
+    bool commitLogBatch() {
+        if (logBatchDepth == 0 || --logBatchDepth > 0) return true;
+        if (replaying || !wal.isOpen()) return true;
+        if (!wal.waitDurable(appliedLsn)) {
+            cout << "Batched operations could not be written to the log.\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Extra delivery targets (file, socket) alongside the in-app inboxes
+    void addNotificationSink(Admin* admin, unique_ptr<NotificationSink> sink) {
+        if (!admin) {
+            cout << "Invalid admin account.\n";
+            return;
+        }
+        dispatcher.addSink(move(sink));
+    }
+
+    // Waits until every queued notification has been delivered
+    void flushNotifications() {
+        dispatcher.flush();
+    }
+
+    void displayUserNotifications(const string& username) {
         if (users.find(username) != users.end()) {
+            dispatcher.flush();
             notificationSystem.displayNotifications(username);
         } else {
             cout << "User not found.\n";
@@ -1875,8 +7140,595 @@ void displayLoggedInAdminMenu() {
     cout << "Enter choice: ";
 }
 
-int main() {
+void displayKioskMenu() {
+    cout << "\n=== Catalog Kiosk ===\n";
+    cout << "1. Find Book by ID\n";
+    cout << "2. Find Book by ISBN\n";
+    cout << "3. Search by Title or Author\n";
+    cout << "4. Exit\n";
+    cout << "Enter choice: ";
+}
+
+// Read-only lookup terminal over a catalog image. Opening checks only the
+// header and layout, so startup costs page faults for what is read; the
+// full-body checksum runs only when asked for (--kiosk <image> --verify).
+int runKiosk(const string& imagePath, bool verifyChecksum) {
+    CatalogImage image;
+    if (!image.open(imagePath)) return 1;
+    if (verifyChecksum && !image.verify()) {
+        cout << "Catalog image " << imagePath << " failed its checksum. Rebuild it from the library.\n";
+        return 1;
+    }
+    cout << "Catalog of " << image.bookCount() << " books as of "
+         << LibraryUtils::formatTimestamp(image.builtAt()) << ".\n";
+
+    while (true) {
+        displayKioskMenu();
+        int choice;
+        if (!(cin >> choice)) return 0;
+
+        switch (choice) {
+            case 1: {
+                int bookId;
+                cout << "Enter book ID: ";
+                cin >> bookId;
+                const CatalogImageRecord* record = image.findById(bookId);
+                if (record) image.displayBook(*record);
+                else cout << "Book not found.\n";
+                break;
+            }
+            case 2: {
+                string isbn;
+                cout << "Enter ISBN: ";
+                cin >> isbn;
+                const CatalogImageRecord* record = image.findByISBN(isbn);
+                if (record) image.displayBook(*record);
+                else cout << "Book not found.\n";
+                break;
+            }
+            case 3: {
+                string query;
+                cout << "Enter search text: ";
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                getline(cin, query);
+                vector<const CatalogImageRecord*> results = image.search(query, KIOSK_SEARCH_LIMIT);
+                if (results.empty()) cout << "No books found.\n";
+                for (const CatalogImageRecord* record : results) image.displayBook(*record);
+                break;
+            }
+            case 4:
+                return 0;
+            default:
+                cout << "Invalid choice. Please try again.\n";
+        }
+    }
+}
+
+// Exports from the snapshot and write-ahead log on disk rather than from a
+// running library, so circulation is never paused. The data is as of the
+// last complete logged operation.
+int runExport(const string& prefix, ExportFormat format) {
+    Library library;
+    if (ifstream(SNAPSHOT_FILE).good() && !library.loadSnapshot(SNAPSHOT_FILE)) {
+        return 1;
+    }
+    library.followLog(WAL_FILE);
+    return library.exportAll(prefix, format) ? 0 : 1;
+}
+
+// Bulk-loads a CSV file into the library on disk, then takes a snapshot
+// so the next start does not replay every imported book
+int runImport(const string& path) {
+    Library library;
+    if (ifstream(SNAPSHOT_FILE).good() && !library.loadSnapshot(SNAPSHOT_FILE)) {
+        return 1;
+    }
+    if (!library.openLog(WAL_FILE)) return 1;
+
+    string username, password;
+    cout << "Admin username: ";
+    cin >> username;
+    cout << "Password: ";
+    cin >> password;
+    Admin* admin = library.authenticateAdmin(username, password);
+    if (!admin) {
+        cout << "Invalid admin credentials.\n";
+        return 1;
+    }
+    if (library.importBooks(admin, path) == 0) return 1;
+    return library.saveSnapshot(SNAPSHOT_FILE) ? 0 : 1;
+}
+
+// Benchmarks: --bench [section]. Each section builds its own library in
+// memory; the console output of the operations being timed is discarded.
+const char* const BENCH_WORDS[] = {
+    "river", "shadow", "garden", "empire", "silent", "winter", "harbor", "crystal",
+    "forest", "machine", "ocean", "golden", "hidden", "storm", "lantern", "desert"
+};
+const char* const BENCH_NAMES[] = {
+    "Austen", "Tolkien", "Morrison", "Achebe", "Murakami", "Atwood", "Borges", "Rowling",
+    "Le Guin", "Dickens", "Orwell", "Lessing", "Calvino", "Okri", "Mantel", "Ishiguro"
+};
+
+// Results of timed scans land here so the compiler keeps the work
+volatile long long benchSink = 0;
+
+double benchSeconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Distinct valid ISBN-13s: 978, the number, then the check digit
+string benchISBN(size_t n) {
+    char digits[14];
+    snprintf(digits, sizeof(digits), "978%09zu", n % 1000000000);
+    int sum = 0;
+    for (int i = 0; i < 12; ++i) sum += (digits[i] - '0') * (i % 2 == 0 ? 1 : 3);
+    digits[12] = static_cast<char>('0' + (10 - sum % 10) % 10);
+    digits[13] = '\0';
+    return digits;
+}
+
+// The i-th generated book, rotating through the three main types
+unique_ptr<Book> benchBook(size_t i) {
+    const size_t words = sizeof(BENCH_WORDS) / sizeof(BENCH_WORDS[0]);
+    const size_t names = sizeof(BENCH_NAMES) / sizeof(BENCH_NAMES[0]);
+    string title = string(BENCH_WORDS[i % words]) + " " + BENCH_WORDS[(i / words) % words] + " " + to_string(i);
+    string author = BENCH_NAMES[(i / 7) % names];
+    int year = 1950 + static_cast<int>(i % 75);
+    switch (i % 3) {
+        case 0:
+            return make_unique<EBook>(title, author, 0, benchISBN(i), "2020-01-01", BookFormat::EBOOK_EPUB,
+                                      2.5, 80000, false, "", "Unknown", "English", "", "Digital", "1st", year);
+        case 1:
+            return make_unique<PrintedBook>(title, author, 0, benchISBN(i), "2020-01-01", BookFormat::PAPERBACK,
+                                            320, "Paperback", "20x13 cm", 0.4, false, "Good", "Unknown",
+                                            "English", "", "Stacks", "1st", year);
+        default:
+            return make_unique<FantasyNovel>(title, author, 0, benchISBN(i), "2020-01-01", "Epic", true, "",
+                                             "Unknown", "English", "", "Fantasy", "1st", year);
+    }
+}
+
+// Adds generated books with IDs 1..count
+void benchAddBooks(Library& library, size_t count) {
+    streambuf* console = cout.rdbuf(nullptr);
+    for (size_t i = 0; i < count; ++i) library.addBook(benchBook(i));
+    cout.rdbuf(console);
+}
+
+// Borrow/return throughput against catalogs of growing size
+void benchCirculation() {
+    const size_t ROUNDS = 100000;
+    cout << "Circulation: " << ROUNDS << " borrow/return pairs\n";
+    for (size_t catalogSize : {10000, 100000, 1000000}) {
+        Library library;
+        benchAddBooks(library, catalogSize);
+        streambuf* console = cout.rdbuf(nullptr);
+        library.registerUser("bench", "Bench@123", "Bench User", "bench@library.com", UserType::PREMIUM);
+        User* user = library.authenticateUser("bench", "Bench@123");
+
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < ROUNDS; ++i) {
+            int bookId = 1 + static_cast<int>((i * 7919) % catalogSize);
+            library.borrowBook(user, bookId);
+            library.returnBook(user, bookId);
+        }
+        double seconds = benchSeconds(start);
+        cout.rdbuf(console);
+        cout << "  " << setw(8) << catalogSize << " books: " << fixed << setprecision(0)
+             << 2 * ROUNDS / seconds << " ops/sec\n";
+    }
+}
+
+// The string date difference Transaction used before it stored day
+// numbers; kept here only as the baseline for benchDates
+int benchStringDaysBetween(const string& date1, const string& date2) {
+    tm tm1 = {}, tm2 = {};
+    istringstream iss1(date1), iss2(date2);
+    iss1 >> get_time(&tm1, "%Y-%m-%d");
+    iss2 >> get_time(&tm2, "%Y-%m-%d");
+    time_t time1 = mktime(&tm1);
+    time_t time2 = mktime(&tm2);
+    return difftime(time2, time1) / (60 * 60 * 24);
+}
+
+// Overdue scan over 1M open loans: string due dates parsed per check
+// against integer due days
+void benchDates() {
+    const size_t LOANS = 1000000;
+    int today = LibraryUtils::currentDay();
+    string todayText = LibraryUtils::formatDay(today);
+    vector<string> dueDates;
+    vector<Transaction> loans;
+    dueDates.reserve(LOANS);
+    loans.reserve(LOANS);
+    for (size_t i = 0; i < LOANS; ++i) {
+        int due = today - 30 + static_cast<int>((i * 7919) % 60);
+        dueDates.push_back(LibraryUtils::formatDay(due));
+        loans.emplace_back(static_cast<int>(i + 1), 1, static_cast<int>(i + 1), TransactionType::BORROW,
+                           LibraryUtils::startOfDay(due - MAX_BORROW_DAYS), due);
+    }
+    cout << "Dates: overdue check over " << LOANS << " open loans\n";
+
+    auto start = chrono::steady_clock::now();
+    size_t overdue = 0;
+    for (const string& due : dueDates) {
+        if (benchStringDaysBetween(due, todayText) > 0) overdue++;
+    }
+    double stringSeconds = benchSeconds(start);
+
+    start = chrono::steady_clock::now();
+    size_t overdueDays = 0;
+    for (const Transaction& loan : loans) {
+        if (loan.getDueDay() < today) overdueDays++;
+    }
+    double daySeconds = benchSeconds(start);
+
+    cout << "  string dates  " << fixed << setprecision(2) << setw(9) << stringSeconds * 1000 << " ms  ("
+         << overdue << " overdue)\n";
+    cout << "  day numbers   " << setw(9) << daySeconds * 1000 << " ms  (" << overdueDays << " overdue)\n";
+}
+
+// Transaction as it was stored before the fixed-size record: strings for
+// the user, the type and the dates. Used only as the benchRecords baseline.
+struct BenchStringTransaction {
+    int transactionId;
+    string username;
+    int bookId;
+    string transactionDate;
+    string dueDate;
+    string returnDate;
+    double lateFee;
+    bool isReturned;
+    string transactionType;
+};
+
+// Full scan of a 2M-record transaction log for one user's open loans,
+// string records against the dense Transaction array
+void benchRecords() {
+    const size_t RECORDS = 2000000;
+    const int USERS = 100000;
+    const int TARGET = (12 * 7919) % USERS;   // has open borrows every 300k records
+    const int REPEATS = 5;
+    const TransactionType types[] = {TransactionType::BORROW, TransactionType::RETURN,
+                                     TransactionType::RENEW, TransactionType::RESERVE};
+    time_t start = LibraryUtils::now() - 365 * 86400;
+    vector<BenchStringTransaction> oldLog;
+    vector<Transaction> log;
+    oldLog.reserve(RECORDS);
+    log.reserve(RECORDS);
+    for (size_t i = 0; i < RECORDS; ++i) {
+        int user = static_cast<int>((i * 7919) % USERS);
+        int book = static_cast<int>(i % 50000) + 1;
+        TransactionType type = types[i % 4];
+        time_t time = start + static_cast<time_t>(i) * 15;
+        int due = LibraryUtils::dayOf(time) + MAX_BORROW_DAYS;
+        bool returned = i % 3 != 0;
+        oldLog.push_back({static_cast<int>(i + 1), "user" + to_string(user), book,
+                          LibraryUtils::formatTimestamp(time), LibraryUtils::formatDay(due),
+                          returned ? LibraryUtils::formatTimestamp(time + 86400) : "", 0.0, returned,
+                          Transaction::typeName(type)});
+        log.emplace_back(static_cast<int>(i + 1), user, book, type, time, due);
+        if (returned) log.back().markReturned(time + 86400);
+    }
+    cout << "Records: open loans of one user in " << RECORDS << " transactions, best of " << REPEATS << "\n";
+
+    string targetName = "user" + to_string(TARGET);
+    double oldBest = 1e9, newBest = 1e9;
+    size_t oldHits = 0, newHits = 0;
+    for (int r = 0; r < REPEATS; ++r) {
+        auto begin = chrono::steady_clock::now();
+        oldHits = 0;
+        for (const BenchStringTransaction& t : oldLog) {
+            if (t.transactionType == "borrow" && !t.isReturned && t.username == targetName) oldHits++;
+        }
+        oldBest = min(oldBest, benchSeconds(begin));
+
+        begin = chrono::steady_clock::now();
+        newHits = 0;
+        for (const Transaction& t : log) {
+            if (t.getType() == TransactionType::BORROW && !t.getIsReturned() && t.getUserId() == TARGET) newHits++;
+        }
+        newBest = min(newBest, benchSeconds(begin));
+    }
+    cout << "  string records " << setw(4) << sizeof(BenchStringTransaction) << " bytes + heap  " << fixed
+         << setprecision(2) << setw(8) << oldBest * 1000 << " ms  (" << oldHits << " found)\n";
+    cout << "  dense records  " << setw(4) << sizeof(Transaction) << " bytes         " << setw(8)
+         << newBest * 1000 << " ms  (" << newHits << " found, " << setprecision(0)
+         << RECORDS * sizeof(Transaction) / newBest / 1048576 << " MiB/s)\n";
+}
+
+// 1M notifications spread over 100k users: sending, fetching every inbox,
+// marking half as read. The old store answered a fetch by scanning every
+// notification; that is timed on 100 users for comparison.
+void benchNotifications() {
+    const int USERS = 100000;
+    const int NOTIFICATIONS = 1000000;
+    const int SCANNED_USERS = 100;
+    vector<string> names;
+    for (int u = 0; u < USERS; ++u) names.push_back("reader" + to_string(u));
+    vector<OutgoingNotification> batch;
+    batch.reserve(NOTIFICATIONS);
+    time_t now = LibraryUtils::now();
+    for (int i = 0; i < NOTIFICATIONS; ++i) {
+        batch.push_back({names[(static_cast<size_t>(i) * 7919) % USERS], "Book #" + to_string(i % 50000 + 1) + " is due tomorrow.",
+                         NotificationType::DUE_DATE_REMINDER, now});
+    }
+    cout << "Notifications: " << NOTIFICATIONS << " across " << USERS << " users\n";
+
+    NotificationSystem system;
+    auto start = chrono::steady_clock::now();
+    for (const auto& note : batch) system.sendNotification(note.recipient, note.message, note.type, note.sentTime);
+    double sendSeconds = benchSeconds(start);
+
+    start = chrono::steady_clock::now();
+    size_t fetched = 0;
+    for (const string& name : names) fetched += system.getUnreadNotifications(name).size();
+    double fetchSeconds = benchSeconds(start);
+
+    start = chrono::steady_clock::now();
+    for (int id = 1; id <= NOTIFICATIONS; id += 2) system.markAsRead(id);
+    double markSeconds = benchSeconds(start);
+
+    size_t unread = 0;
+    for (const string& name : names) unread += system.getUnreadCount(name);
+
+    start = chrono::steady_clock::now();
+    size_t scanned = 0;
+    for (int u = 0; u < SCANNED_USERS; ++u) {
+        for (const auto& note : batch) {
+            if (note.recipient == names[u]) scanned++;
+        }
+    }
+    double scanSeconds = benchSeconds(start);
+
+    cout << fixed << setprecision(2);
+    cout << "  send all          " << setw(9) << sendSeconds * 1000 << " ms\n";
+    cout << "  fetch all inboxes " << setw(9) << fetchSeconds * 1000 << " ms  (" << fetched << " notifications, "
+         << setprecision(3) << fetchSeconds * 1e6 / USERS << " us per user)\n";
+    cout << "  mark half read    " << setprecision(2) << setw(9) << markSeconds * 1000 << " ms  ("
+         << unread << " left unread)\n";
+    cout << "  full-store scan   " << setw(9) << scanSeconds * 1e6 / SCANNED_USERS / 1000 << " ms per user  ("
+         << scanned << " found for " << SCANNED_USERS << " users)\n";
+}
+
+// Resident set size in bytes, or 0 where /proc/self/statm is unavailable
+size_t benchResidentBytes() {
+#ifdef _WIN32
+    return 0;
+#else
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) return 0;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// Resident memory of 1M generated books with three tags each, measured
+// rather than estimated
+void benchMemory() {
+    const size_t BOOKS = 1000000;
+    const size_t words = sizeof(BENCH_WORDS) / sizeof(BENCH_WORDS[0]);
+    size_t before = benchResidentBytes();
+    if (before == 0) {
+        cout << "Memory: /proc/self/statm is not available here\n";
+        return;
+    }
+    vector<unique_ptr<Book>> books;
+    books.reserve(BOOKS);
+    size_t afterVector = benchResidentBytes();
+    for (size_t i = 0; i < BOOKS; ++i) {
+        unique_ptr<Book> book = benchBook(i);
+        for (size_t t = 0; t < 3; ++t) book->addTag(BENCH_WORDS[(i + t * 5) % words]);
+        books.push_back(move(book));
+    }
+    size_t after = benchResidentBytes();
+    cout << "Memory: " << BOOKS << " books, resident set from /proc/self/statm\n";
+    cout << "  before      " << fixed << setprecision(1) << before / 1048576.0 << " MiB\n";
+    cout << "  after       " << after / 1048576.0 << " MiB\n";
+    cout << "  per book    " << setprecision(0) << static_cast<double>(after - afterVector) / BOOKS
+         << " bytes (excluding the pointer vector)\n";
+}
+
+// Stats report scans: walking Book objects against the column arrays, over
+// a 1M-book catalog
+void benchColumns() {
+    const size_t BOOKS = 1000000;
+    const int REPEATS = 10;
+    vector<unique_ptr<Book>> books;
+    CatalogColumns columns;
+    streambuf* console = cout.rdbuf(nullptr);
+    for (size_t i = 0; i < BOOKS; ++i) {
+        unique_ptr<Book> book = benchBook(i);
+        book->setId(static_cast<int>(i + 1));
+        for (size_t b = 0; b < (i * 7919) % 13; ++b) book->recordBorrow("bench");
+        book->updateStatus(i % 5 == 0 ? BookStatus::BORROWED : BookStatus::AVAILABLE);
+        columns.add(book.get());
+        books.push_back(move(book));
+    }
+    cout.rdbuf(console);
+    cout << "Columns: " << BOOKS << " books, best of " << REPEATS << " runs (ms)\n";
+
+    auto best = [&](const function<long long()>& scan) {
+        double fastest = 1e9;
+        for (int r = 0; r < REPEATS; ++r) {
+            auto start = chrono::steady_clock::now();
+            benchSink = scan();
+            fastest = min(fastest, benchSeconds(start) * 1000);
+        }
+        return fastest;
+    };
+    auto report = [](const string& label, double objectMs, double columnMs) {
+        cout << "  " << left << setw(16) << label << right << fixed << setprecision(2)
+             << "objects " << setw(8) << objectMs << "   columns " << setw(8) << columnMs << "\n";
+    };
+
+    report("total borrows",
+           best([&] {
+               long long total = 0;
+               for (const auto& book : books) total += book->getBorrowCount();
+               return total;
+           }),
+           best([&] { return columns.totalBorrows(); }));
+
+    report("top 10 borrowed",
+           best([&] {
+               vector<const Book*> order;
+               order.reserve(books.size());
+               for (const auto& book : books) order.push_back(book.get());
+               partial_sort(order.begin(), order.begin() + 10, order.end(), [](const Book* a, const Book* b) {
+                   return a->getBorrowCount() != b->getBorrowCount() ? a->getBorrowCount() > b->getBorrowCount()
+                                                                     : a->getId() < b->getId();
+               });
+               return static_cast<long long>(order[0]->getId());
+           }),
+           best([&] { return static_cast<long long>(columns.mostBorrowed(10)[0].first); }));
+
+    report("type/status",
+           best([&] {
+               map<string, int> types;
+               map<BookStatus, int> statuses;
+               for (const auto& book : books) {
+                   types[book->getBookType()]++;
+                   statuses[book->getStatus()]++;
+               }
+               return static_cast<long long>(types.size() + statuses.size());
+           }),
+           best([&] { return static_cast<long long>(columns.typeCounts().size() + columns.statusCounts().size()); }));
+
+    report("genre",
+           best([&] {
+               map<string, int> genres;
+               for (const auto& book : books) genres[book->getGenre()]++;
+               return static_cast<long long>(genres.size());
+           }),
+           best([&] { return static_cast<long long>(columns.genreCounts().size()); }));
+}
+
+// Segment skipping in the transaction log: five years of history, a few
+// hundred loans still open
+void benchTransactionLog() {
+    const size_t RECORDS = 2000000;
+    const time_t START = LibraryUtils::startOfDay(LibraryUtils::currentDay() - 5 * 365);
+    const time_t STEP = 5 * 365 * 86400 / RECORDS;
+    TransactionLog log;
+    for (size_t i = 0; i < RECORDS; ++i) {
+        time_t time = START + static_cast<time_t>(i) * STEP;
+        int bookId = 1 + static_cast<int>((i * 7919) % 100000);
+        size_t at = log.append(Transaction(static_cast<int>(i + 1), 1 + static_cast<int>(i % 5000), bookId,
+                                           TransactionType::BORROW, time, LibraryUtils::dayOf(time) + MAX_BORROW_DAYS));
+        if (i % 5000 != 0) log.markReturned(at, time + 86400);
+    }
+    int lastDay = LibraryUtils::dayOf(START + static_cast<time_t>(RECORDS) * STEP);
+    cout << "Transaction log: " << RECORDS << " records in " << log.segmentCount() << " segments\n";
+
+    size_t matched = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < log.size(); ++i) {
+        int day = LibraryUtils::dayOf(log[i].getTransactionTime());
+        if (day >= lastDay - 30 && day <= lastDay) matched += log[i].getBookId() != 0;
+    }
+    cout << "  last 30 days, full scan with per-record day:  " << fixed << setprecision(2)
+         << benchSeconds(start) * 1000 << " ms (" << matched << " records)\n";
+
+    matched = 0;
+    start = chrono::steady_clock::now();
+    log.forEachInRange(lastDay - 30, lastDay, [&](const Transaction& trans) { matched += trans.getBookId() != 0; });
+    cout << "  last 30 days, forEachInRange:                 " << benchSeconds(start) * 1000
+         << " ms (" << matched << " records)\n";
+
+    matched = 0;
+    start = chrono::steady_clock::now();
+    log.forEachInRange(lastDay - 365, lastDay, [&](const Transaction& trans) { matched += trans.getBookId() != 0; });
+    cout << "  last year, forEachInRange:                    " << benchSeconds(start) * 1000
+         << " ms (" << matched << " records)\n";
+
+    matched = 0;
+    start = chrono::steady_clock::now();
+    log.forEachOpenLoan([&](size_t, const Transaction&) { matched++; });
+    cout << "  open loans, forEachOpenLoan:                  " << benchSeconds(start) * 1000
+         << " ms (" << matched << " loans)\n";
+
+    matched = 0;
+    start = chrono::steady_clock::now();
+    log.forEachForBook(4242, [&](const Transaction& trans) { matched += trans.getBookId() != 0; });
+    cout << "  one book's history, forEachForBook:           " << benchSeconds(start) * 1000
+         << " ms (" << matched << " records)\n";
+}
+
+// Typo-tolerant search latency on a 1M-book catalog
+void benchFuzzySearch() {
+    const size_t BOOKS = 1000000;
+    const int REPEAT = 50;
+    const char* const queries[] = {"tolkein", "murakmi", "atwod", "ishigro", "shadw rivr", "crystl gardn", "lanter 4242"};
+    Library library;
+    benchAddBooks(library, BOOKS);
+    auto start = chrono::steady_clock::now();
+    library.searchBooksFuzzy("warmup", 10);
+    cout << "Fuzzy search over " << BOOKS << " books (index built in " << fixed << setprecision(2)
+         << benchSeconds(start) << " s)\n";
+    for (const char* query : queries) {
+        size_t found = 0;
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < REPEAT; ++i) found = library.searchBooksFuzzy(query, 10).size();
+        cout << "  " << left << setw(14) << query << right << setw(9) << setprecision(1)
+             << benchSeconds(start) / REPEAT * 1e6 << " us/query (" << found << " results)\n";
+    }
+}
+
+int runBenchmarks(const string& section) {
+    const vector<pair<string, void (*)()>> sections = {
+        {"circulation", benchCirculation},
+        {"columns", benchColumns},
+        {"dates", benchDates},
+        {"fuzzy", benchFuzzySearch},
+        {"memory", benchMemory},
+        {"notifications", benchNotifications},
+        {"records", benchRecords},
+        {"transactions", benchTransactionLog}
+    };
+    bool ran = false;
+    for (const auto& entry : sections) {
+        if (section.empty() || section == entry.first) {
+            entry.second();
+            ran = true;
+        }
+    }
+    if (!ran) {
+        cout << "Unknown benchmark section: " << section << ". Sections:";
+        for (const auto& entry : sections) cout << " " << entry.first;
+        cout << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        return runBenchmarks(argc > 2 ? argv[2] : "");
+    }
+    if (argc > 2 && string(argv[1]) == "--kiosk") {
+        return runKiosk(argv[2], argc > 3 && string(argv[3]) == "--verify");
+    }
+    if (argc > 2 && string(argv[1]) == "--export") {
+        bool csv = argc > 3 && string(argv[3]) == "csv";
+        return runExport(argv[2], csv ? ExportFormat::CSV : ExportFormat::JSON_LINES);
+    }
+    if (argc > 2 && string(argv[1]) == "--import") {
+        return runImport(argv[2]);
+    }
+
+    // A snapshot that exists but cannot be read must not be replaced by
+    // a log replayed onto an empty library
     Library library;
+    if (ifstream(SNAPSHOT_FILE).good() && !library.loadSnapshot(SNAPSHOT_FILE)) {
+        cout << "Cannot start: " << SNAPSHOT_FILE << " could not be loaded. Restore it or move it aside.\n";
+        return 1;
+    }
+    if (!library.openLog(WAL_FILE)) {
+        cout << "Cannot start: the write-ahead log could not be opened.\n";
+        return 1;
+    }
 
     while (true) {
         displayMainMenu();
@@ -1899,6 +7751,8 @@ int main() {
                 break;
             }
             case 4:
+                library.saveSnapshot(SNAPSHOT_FILE);
+                library.saveCatalogImage(CATALOG_IMAGE_FILE);
                 cout << "Exiting the system. Goodbye!\n";
                 return 0;
             default: